@@ -0,0 +1,59 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Helpers shared by the standalone benchmarks. Each bench_*.cpp builds on its own from this directory:
+//   g++ -std=c++17 -O2 -march=native -pthread -I.. bench_<name>.cpp -o bench_<name>
+//   cl /std:c++17 /O2 /EHsc /arch:AVX2 /I.. bench_<name>.cpp
+namespace bench
+{
+	using clock = std::chrono::steady_clock;
+
+	inline double ms_since(clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+	}
+
+	// Best wall time of runs calls to f, in ms; setup runs untimed before each call
+	template<class Setup, class F>
+	double best_ms(int runs, Setup setup, F f)
+	{
+		double best = 0;
+		for (int i = 0; i < runs; ++i)
+		{
+			setup();
+
+			clock::time_point start = clock::now();
+			f();
+			double elapsed = ms_since(start);
+
+			if (i == 0 || elapsed < best) best = elapsed;
+		}
+
+		return best;
+	}
+
+	template<class T>
+	std::vector<T> random_values(size_t n, uint64_t seed)
+	{
+		std::mt19937_64 rng(seed);
+		std::vector<T> values(n);
+		for (T& value : values)
+			value = static_cast<T>(rng());
+
+		return values;
+	}
+
+	// Results are folded in here so the optimizer cannot drop the measured work
+	inline volatile uint64_t sink = 0;
+
+	template<class T>
+	void keep(const T& value)
+	{
+		sink = sink + static_cast<uint64_t>(value);
+	}
+}
@@ -0,0 +1,59 @@
+#include "bench.h"
+#include "my_frozen_tree.h"
+#include "my_tree.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Random lower_bound queries on a pointer Tree, on its frozen Eytzinger layout, and batched through lower_bound_many.
+// Usage: bench_frozen_tree [keys = 4194304] [queries = 2097152]
+int main(int argc, char** argv)
+{
+	const int n = argc > 1 ? std::atoi(argv[1]) : 1 << 22;
+	const size_t queries = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : size_t(1) << 21;
+
+	std::vector<std::pair<int, int>> pairs;
+	pairs.reserve(static_cast<size_t>(n));
+	for (int i = 0; i < n; ++i)
+		pairs.emplace_back(2 * i, i);
+
+	auto tree = ist::Tree<int, int>::from_sorted(pairs.begin(), pairs.end());
+	auto frozen = tree.freeze();
+
+	std::vector<int> keys = bench::random_values<int>(queries, 39);
+	for (int& key : keys)
+		key = static_cast<int>(static_cast<unsigned>(key) % (2u * static_cast<unsigned>(n)));
+
+	uint64_t tree_sum = 0, frozen_sum = 0, batch_sum = 0;
+
+	double tree_ms = bench::best_ms(3, [&] { tree_sum = 0; }, [&]
+	{
+		for (int key : keys)
+			tree_sum += tree.lower_bound(key)->value;
+	});
+
+	double frozen_ms = bench::best_ms(3, [&] { frozen_sum = 0; }, [&]
+	{
+		for (int key : keys)
+			frozen_sum += frozen.lower_bound(key)->value;
+	});
+
+	std::vector<decltype(frozen)::const_iterator> found;
+	found.reserve(queries);
+
+	double batch_ms = bench::best_ms(3, [&] { batch_sum = 0; found.clear(); }, [&]
+	{
+		frozen.lower_bound_many(keys.data(), keys.size(), std::back_inserter(found));
+		for (auto it : found)
+			batch_sum += it->value;
+	});
+
+	if (tree_sum != frozen_sum || tree_sum != batch_sum) throw std::runtime_error("bench_frozen_tree: results differ");
+
+	std::printf("%d keys, %zu queries\ntree    %8.1f ms\nfrozen  %8.1f ms  (%.1fx)\nbatched %8.1f ms  (%.1fx)\n",
+		n, queries, tree_ms, frozen_ms, tree_ms / frozen_ms, batch_ms, tree_ms / batch_ms);
+}
@@ -0,0 +1,85 @@
+#include "bench.h"
+#include "my_interval_tree.h"
+
+#include <cstdio>
+#include <stdexcept>
+#include <vector>
+
+// IntervalMap overlap, stab and any-overlap queries against a linear scan of the same intervals.
+// Intervals are short and spread over a wide key range, the common case where few of them match.
+int main()
+{
+	const int range = 1 << 30;
+	const int max_length = 1 << 12;
+
+	for (size_t n : { size_t(1000), size_t(10000), size_t(100000), size_t(1000000) })
+	{
+		std::vector<int> randoms = bench::random_values<int>(2 * n, n);
+		std::vector<ist::Interval<int>> intervals(n);
+		ist::IntervalMap<int, int> map;
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			int lo = static_cast<int>(static_cast<unsigned>(randoms[2 * i]) % range);
+			intervals[i] = { lo, lo + static_cast<int>(static_cast<unsigned>(randoms[2 * i + 1]) % max_length) };
+			map.emplace(intervals[i], static_cast<int>(i));
+		}
+
+		// Keep the scan side to a few hundred million interval tests
+		const size_t queries = std::min<size_t>(100000, 200000000 / n);
+		std::vector<int> points = bench::random_values<int>(queries, n + 1);
+		for (int& point : points)
+			point = static_cast<int>(static_cast<unsigned>(point) % range);
+
+		size_t tree_hits = 0, scan_hits = 0, tree_stabs = 0, scan_stabs = 0;
+		const int window = 1 << 16;
+
+		double tree_overlap = bench::best_ms(3, [&] { tree_hits = 0; }, [&]
+		{
+			for (int lo : points)
+				map.overlap(lo, lo + window, [&tree_hits](const auto&) { ++tree_hits; });
+		});
+
+		double scan_overlap = bench::best_ms(3, [&] { scan_hits = 0; }, [&]
+		{
+			for (int lo : points)
+				for (const ist::Interval<int>& interval : intervals)
+					scan_hits += !(lo + window < interval.lo) && !(interval.hi < lo);
+		});
+
+		double tree_stab = bench::best_ms(3, [&] { tree_stabs = 0; }, [&]
+		{
+			for (int x : points)
+				map.stab(x, [&tree_stabs](const auto&) { ++tree_stabs; });
+		});
+
+		double scan_stab = bench::best_ms(3, [&] { scan_stabs = 0; }, [&]
+		{
+			for (int x : points)
+				for (const ist::Interval<int>& interval : intervals)
+					scan_stabs += !(x < interval.lo) && !(interval.hi < x);
+		});
+
+		if (tree_hits != scan_hits || tree_stabs != scan_stabs) throw std::runtime_error("bench_interval_map: query results differ");
+
+		size_t tree_found = 0, scan_found = 0;
+
+		double tree_exists = bench::best_ms(3, [&] { tree_found = 0; }, [&]
+		{
+			for (int lo : points)
+				tree_found += map.overlaps(lo, lo + window);
+		});
+
+		double scan_exists = bench::best_ms(3, [&] { scan_found = 0; }, [&]
+		{
+			for (int lo : points)
+				scan_found += std::any_of(intervals.begin(), intervals.end(),
+					[lo, window](const ist::Interval<int>& interval) { return !(lo + window < interval.lo) && !(interval.hi < lo); });
+		});
+
+		if (tree_found != scan_found) throw std::runtime_error("bench_interval_map: overlaps results differ");
+
+		std::printf("n=%8zu  %6zu queries   overlap %8.2f / %9.2f ms   stab %8.2f / %9.2f ms   overlaps %8.2f / %9.2f ms  (tree / scan)\n",
+			n, queries, tree_overlap, scan_overlap, tree_stab, scan_stab, tree_exists, scan_exists);
+	}
+}
@@ -0,0 +1,45 @@
+#include "bench.h"
+#include "my_parallel_sort.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// parallel_merge_sort scaling from one worker to every core, against std::sort, std::stable_sort and merge_sort.
+// Usage: bench_parallel_sort [elements = 10000000]
+int main(int argc, char** argv)
+{
+	const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+	const std::vector<int> input = bench::random_values<int>(n, 42);
+
+	std::vector<int> expected = input;
+	std::vector<int> data;
+	auto reset = [&data, &input] { data = input; };
+
+	double std_sort = bench::best_ms(3, reset, [&data] { std::sort(data.begin(), data.end()); });
+	expected = data;
+
+	double std_stable = bench::best_ms(3, reset, [&data] { std::stable_sort(data.begin(), data.end()); });
+	double merge = bench::best_ms(3, reset, [&data] { ist::merge_sort(data.begin(), data.end()); });
+
+	std::printf("%zu ints\nstd::sort         %8.1f ms\nstd::stable_sort  %8.1f ms\nmerge_sort        %8.1f ms\n", n, std_sort, std_stable, merge);
+
+	const unsigned cores = std::max(std::thread::hardware_concurrency(), 1u);
+	double single = 0;
+
+	for (unsigned threads = 1; ; threads = std::min(threads * 2, cores))
+	{
+		ist::WorkStealingPool pool(threads);
+		double elapsed = bench::best_ms(3, reset, [&data, &pool] { ist::parallel_merge_sort(pool, data.begin(), data.end()); });
+
+		if (data != expected) throw std::runtime_error("bench_parallel_sort: wrong result");
+		if (threads == 1) single = elapsed;
+
+		std::printf("parallel x%-3u     %8.1f ms  speedup %.2fx vs 1 thread, %.2fx vs std::sort\n", threads, elapsed, single / elapsed, std_sort / elapsed);
+
+		if (threads == cores) break;
+	}
+}
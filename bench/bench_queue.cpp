@@ -0,0 +1,150 @@
+#include "bench.h"
+#include "my_concurrent_queue.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Throughput and push-to-pop latency percentiles of MpmcQueue and MpscQueue across producer/consumer counts.
+// Producers push flat out, so latency includes the time a message waits behind a full queue.
+// Usage: bench_queue [spin|yield|block = block] [messages = 2000000]
+namespace
+{
+	uint64_t now_ns()
+	{
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(bench::clock::now().time_since_epoch()).count());
+	}
+
+	struct Message : ist::MpscNode
+	{
+		uint64_t stamp = 0;
+	};
+
+	void report(const char* queue, unsigned producers, unsigned consumers, size_t messages, double elapsed_ms, std::vector<uint64_t>& latencies)
+	{
+		std::sort(latencies.begin(), latencies.end());
+		auto percentile = [&latencies](double p) { return latencies[std::min(latencies.size() - 1, static_cast<size_t>(p * latencies.size()))]; };
+
+		std::printf("%s %2up %2uc  %7.2f M msg/s  p50 %7llu ns  p99 %8llu ns  p99.9 %9llu ns\n", queue, producers, consumers,
+			messages / elapsed_ms / 1000.0, static_cast<unsigned long long>(percentile(0.5)),
+			static_cast<unsigned long long>(percentile(0.99)), static_cast<unsigned long long>(percentile(0.999)));
+	}
+
+	void run_mpmc(unsigned producers, unsigned consumers, size_t messages, ist::wait_mode mode)
+	{
+		// Zero is the stop message, so stamps are offset by one
+		ist::MpmcQueue<uint64_t> queue(size_t(1) << 14);
+		const size_t per_producer = messages / producers;
+
+		std::vector<std::vector<uint64_t>> latencies(consumers);
+		std::vector<std::thread> threads;
+
+		bench::clock::time_point start = bench::clock::now();
+
+		for (unsigned c = 0; c < consumers; ++c)
+		{
+			threads.emplace_back([&queue, &latencies, c, mode, per_producer, producers, consumers]
+			{
+				std::vector<uint64_t>& samples = latencies[c];
+				samples.reserve(per_producer * producers / consumers + 1);
+
+				for (uint64_t stamp; (stamp = queue.pop(mode)) != 0; )
+					samples.push_back(now_ns() - (stamp - 1));
+			});
+		}
+
+		for (unsigned p = 0; p < producers; ++p)
+		{
+			threads.emplace_back([&queue, mode, per_producer]
+			{
+				for (size_t i = 0; i < per_producer; ++i)
+					queue.push(now_ns() + 1, mode);
+			});
+		}
+
+		for (unsigned p = 0; p < producers; ++p)
+			threads[consumers + p].join();
+
+		for (unsigned c = 0; c < consumers; ++c)
+			queue.push(0, mode);
+
+		for (unsigned c = 0; c < consumers; ++c)
+			threads[c].join();
+
+		double elapsed = bench::ms_since(start);
+
+		std::vector<uint64_t> all;
+		for (std::vector<uint64_t>& samples : latencies)
+			all.insert(all.end(), samples.begin(), samples.end());
+
+		report("mpmc", producers, consumers, per_producer * producers, elapsed, all);
+	}
+
+	void run_mpsc(unsigned producers, size_t messages, ist::wait_mode mode)
+	{
+		ist::MpscQueue<Message> queue;
+		const size_t per_producer = messages / producers;
+		const size_t total = per_producer * producers;
+
+		// Messages are intrusive, so each producer owns its nodes up front
+		std::unique_ptr<Message[]> nodes(new Message[total]);
+		std::vector<uint64_t> latencies;
+		latencies.reserve(total);
+
+		bench::clock::time_point start = bench::clock::now();
+
+		std::thread consumer([&queue, &latencies, total, mode]
+		{
+			for (size_t i = 0; i < total; ++i)
+			{
+				uint64_t stamp = queue.pop(mode)->stamp;
+				latencies.push_back(now_ns() - stamp);
+			}
+		});
+
+		std::vector<std::thread> threads;
+		for (unsigned p = 0; p < producers; ++p)
+		{
+			threads.emplace_back([&queue, &nodes, p, per_producer]
+			{
+				for (Message* message = &nodes[p * per_producer]; message != &nodes[(p + 1) * per_producer]; ++message)
+				{
+					message->stamp = now_ns();
+					queue.push(message);
+				}
+			});
+		}
+
+		for (std::thread& thread : threads)
+			thread.join();
+
+		consumer.join();
+
+		report("mpsc", producers, 1, total, bench::ms_since(start), latencies);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	ist::wait_mode mode = ist::wait_mode::block;
+	if (argc > 1 && std::strcmp(argv[1], "spin") == 0) mode = ist::wait_mode::spin;
+	if (argc > 1 && std::strcmp(argv[1], "yield") == 0) mode = ist::wait_mode::yield;
+
+	const size_t messages = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 2000000;
+	const unsigned cores = std::max(std::thread::hardware_concurrency(), 2u);
+
+	std::vector<unsigned> counts;
+	for (unsigned n = 1; n <= cores; n *= 2)
+		counts.push_back(n);
+
+	for (unsigned producers : counts)
+		for (unsigned consumers : counts)
+			run_mpmc(producers, consumers, messages, mode);
+
+	for (unsigned producers : counts)
+		run_mpsc(producers, messages, mode);
+}
@@ -0,0 +1,126 @@
+#include "bench.h"
+#include "my_sort.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Single-threaded sort timings on random and patterned inputs, each result checked against std::sort
+namespace
+{
+	// Best of three runs of sort over fresh copies of input
+	template<class T, class Sort>
+	double time_sort(const std::vector<T>& input, const std::vector<T>& expected, Sort sort)
+	{
+		std::vector<T> data;
+		double elapsed = bench::best_ms(3, [&data, &input] { data = input; }, [&data, &sort] { sort(data); });
+
+		if (data != expected) throw std::runtime_error("bench_sort: wrong result");
+		return elapsed;
+	}
+
+	template<class T>
+	std::vector<T> sorted(std::vector<T> values)
+	{
+		std::sort(values.begin(), values.end());
+		return values;
+	}
+
+	void bench_radix_sort()
+	{
+		const std::vector<uint32_t> input = bench::random_values<uint32_t>(10000000, 43);
+		const std::vector<uint32_t> expected = sorted(input);
+
+		double radix = time_sort(input, expected, [](std::vector<uint32_t>& data) { ist::radix_sort(data.begin(), data.end()); });
+		double std_sort = time_sort(input, expected, [](std::vector<uint32_t>& data) { std::sort(data.begin(), data.end()); });
+
+		std::printf("10M random uint32\n  radix_sort %8.1f ms\n  std::sort  %8.1f ms  (radix %.1fx faster)\n", radix, std_sort, std_sort / radix);
+	}
+
+	// std::less_equal takes the SIMD kernels; an equivalent lambda is the scalar path on the same data
+	template<class T>
+	void bench_simd_merge_sort(const char* label)
+	{
+		const std::vector<T> input = bench::random_values<T>(10000000, 44);
+		const std::vector<T> expected = sorted(input);
+		std::vector<T> buffer(ist::merge_sort_buffer_size(input.size()));
+
+		double simd = time_sort(input, expected, [&buffer](std::vector<T>& data)
+		{
+			ist::merge_sort_buffered(data.begin(), data.end(), buffer.begin(), std::less_equal<>());
+		});
+
+		double scalar = time_sort(input, expected, [&buffer](std::vector<T>& data)
+		{
+			ist::merge_sort_buffered(data.begin(), data.end(), buffer.begin(), [](T a, T b) { return a <= b; });
+		});
+
+		double std_sort = time_sort(input, expected, [](std::vector<T>& data) { std::sort(data.begin(), data.end()); });
+
+		std::printf("10M random %s\n  merge_sort simd   %8.1f ms  (%.1fx scalar)\n  merge_sort scalar %8.1f ms\n  std::sort         %8.1f ms\n",
+			label, simd, scalar / simd, scalar, std_sort);
+	}
+
+	void bench_quick_sort()
+	{
+		const size_t n = 2000000;
+		std::vector<int> random = bench::random_values<int>(n, 46);
+		std::vector<int> ascending(n), descending(n), few_keys(n), organ_pipe(n);
+
+		for (size_t i = 0; i < n; ++i)
+		{
+			ascending[i] = static_cast<int>(i);
+			descending[i] = static_cast<int>(n - i);
+			few_keys[i] = random[i] & 15;
+			organ_pipe[i] = static_cast<int>(i < n / 2 ? i : n - i);
+		}
+
+		std::printf("2M ints          quick_sort  merge_sort   std::sort\n");
+
+		for (auto [label, input] : { std::pair<const char*, const std::vector<int>*>{ "random", &random }, { "ascending", &ascending },
+			{ "descending", &descending }, { "16 keys", &few_keys }, { "organ pipe", &organ_pipe } })
+		{
+			const std::vector<int> expected = sorted(*input);
+
+			double quick = time_sort(*input, expected, [](std::vector<int>& data) { ist::quick_sort(data.begin(), data.end()); });
+			double merge = time_sort(*input, expected, [](std::vector<int>& data) { ist::merge_sort(data.begin(), data.end()); });
+			double std_sort = time_sort(*input, expected, [](std::vector<int>& data) { std::sort(data.begin(), data.end()); });
+
+			std::printf("  %-12s %8.1f ms %8.1f ms %8.1f ms\n", label, quick, merge, std_sort);
+		}
+	}
+
+	void bench_tim_sort()
+	{
+		const size_t n = 2000000;
+		const std::vector<int> random = bench::random_values<int>(n, 49);
+
+		// One element in a thousand displaced
+		std::vector<int> nearly_sorted(n);
+		for (size_t i = 0; i < n; ++i)
+			nearly_sorted[i] = static_cast<int>(i) + (random[i] % 1000 == 0 ? random[(i + 1) % n] % 100000 : 0);
+
+		std::printf("2M ints          tim_sort    merge_sort\n");
+
+		for (auto [label, input] : { std::pair<const char*, const std::vector<int>*>{ "random", &random }, { "nearly sorted", &nearly_sorted } })
+		{
+			const std::vector<int> expected = sorted(*input);
+
+			double tim = time_sort(*input, expected, [](std::vector<int>& data) { ist::tim_sort(data.begin(), data.end()); });
+			double merge = time_sort(*input, expected, [](std::vector<int>& data) { ist::merge_sort(data.begin(), data.end()); });
+
+			std::printf("  %-13s %8.1f ms %8.1f ms\n", label, tim, merge);
+		}
+	}
+}
+
+int main()
+{
+	bench_radix_sort();
+	bench_simd_merge_sort<int32_t>("int32");
+	bench_simd_merge_sort<int64_t>("int64");
+	bench_quick_sort();
+	bench_tim_sort();
+}
@@ -0,0 +1,922 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace ist
+{
+	template<class K, class T>
+	struct BPlusTreeEntry
+	{
+		const K& key;
+		T&       value;
+	};
+
+	template<class Entry>
+	struct BPlusTreeArrow
+	{
+		Entry entry;
+
+		const Entry* operator->() const noexcept
+		{
+			return &entry;
+		}
+	};
+
+	template<class Tree>
+	class ConstBPlusTreeIterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using difference_type   = ptrdiff_t;
+
+		using key_type   = typename Tree::key_type;
+		using value_type = BPlusTreeEntry<key_type, const typename Tree::value_type>;
+		using leaf_ptr   = typename Tree::leaf_ptr;
+		using reference  = value_type;
+		using pointer    = BPlusTreeArrow<value_type>;
+
+		ConstBPlusTreeIterator() noexcept : leaf{}, idx{}, tree{} {}
+
+		explicit ConstBPlusTreeIterator(leaf_ptr leaf, size_t idx, const Tree* tree) noexcept
+			: leaf{ leaf }, idx{ idx }, tree{ tree } {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return { leaf->keys[idx], leaf->values[idx] };
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return { **this };
+		}
+
+		ConstBPlusTreeIterator& operator++() noexcept
+		{
+			if (++idx == leaf->count)
+			{
+				leaf = leaf->next;
+				idx = 0;
+			}
+
+			return *this;
+		}
+
+		ConstBPlusTreeIterator operator++(int) noexcept
+		{
+			ConstBPlusTreeIterator tmp = *this;
+			++* this;
+			return tmp;
+		}
+
+		ConstBPlusTreeIterator& operator--() noexcept
+		{
+			if (!leaf || idx == 0)
+			{
+				leaf = leaf ? leaf->prev : tree->last_;
+				idx = leaf->count;
+			}
+
+			--idx;
+			return *this;
+		}
+
+		ConstBPlusTreeIterator operator--(int) noexcept
+		{
+			ConstBPlusTreeIterator tmp = *this;
+			--* this;
+			return tmp;
+		}
+
+		[[nodiscard]] bool operator==(const ConstBPlusTreeIterator& other) const noexcept
+		{
+			return leaf == other.leaf && idx == other.idx;
+		}
+
+		[[nodiscard]] bool operator!=(const ConstBPlusTreeIterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+		leaf_ptr    leaf;
+		size_t      idx;
+		const Tree* tree;
+	};
+
+	template<class Tree>
+	class BPlusTreeIterator : public ConstBPlusTreeIterator<Tree>
+	{
+	public:
+		using my_base = ConstBPlusTreeIterator<Tree>;
+
+		using key_type   = typename Tree::key_type;
+		using value_type = BPlusTreeEntry<key_type, typename Tree::value_type>;
+		using leaf_ptr   = typename Tree::leaf_ptr;
+		using reference  = value_type;
+		using pointer    = BPlusTreeArrow<value_type>;
+
+		BPlusTreeIterator() noexcept {}
+
+		explicit BPlusTreeIterator(leaf_ptr leaf, size_t idx, const Tree* tree) noexcept
+			: my_base(leaf, idx, tree) {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return { this->leaf->keys[this->idx], this->leaf->values[this->idx] };
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return { **this };
+		}
+
+		BPlusTreeIterator& operator++() noexcept
+		{
+			my_base::operator++();
+			return *this;
+		}
+
+		BPlusTreeIterator operator++(int) noexcept
+		{
+			BPlusTreeIterator iterator = *this;
+			my_base::operator++();
+			return iterator;
+		}
+
+		BPlusTreeIterator& operator--() noexcept
+		{
+			my_base::operator--();
+			return *this;
+		}
+
+		BPlusTreeIterator operator--(int) noexcept
+		{
+			BPlusTreeIterator iterator = *this;
+			my_base::operator--();
+			return iterator;
+		}
+	};
+
+	// Four cache lines, or enough whole lines for four entries of large key and value types;
+	// the extra line covers the node header, padding and leaf links
+	template<class K, class T>
+	constexpr size_t bplus_tree_node_bytes() noexcept
+	{
+		size_t entry = std::max(sizeof(K) + sizeof(T), sizeof(K) + sizeof(void*));
+		size_t bytes = (4 * entry + 63) / 64 * 64 + 64;
+
+		return std::max<size_t>(bytes, 256);
+	}
+
+	template<class K, class T, size_t NodeBytes = bplus_tree_node_bytes<K, T>()>
+	class BPlusTree
+	{
+	public:
+		using key_type        = K;
+		using value_type      = T;
+
+		using reference       = value_type&;
+		using pointer         = value_type*;
+
+		using const_reference = const value_type&;
+		using const_pointer   = const value_type*;
+
+		static constexpr size_t cache_line = 64;
+
+	private:
+		struct node_base
+		{
+			size_t count = 0;
+			bool   leaf;
+
+			explicit node_base(bool leaf) : leaf(leaf) {}
+		};
+
+		static constexpr size_t align_up(size_t bytes, size_t align) noexcept
+		{
+			return (bytes + align - 1) / align * align;
+		}
+
+		// Node sizes as the compiler lays them out: the header, each array at its alignment, the
+		// trailing pointers, and the whole node rounded up to a cache line
+		static constexpr size_t leaf_bytes(size_t capacity) noexcept
+		{
+			size_t bytes = align_up(sizeof(node_base), alignof(K)) + capacity * sizeof(K);
+			bytes = align_up(bytes, alignof(T)) + capacity * sizeof(T);
+			bytes = align_up(bytes, alignof(void*)) + 2 * sizeof(void*);
+
+			return align_up(bytes, cache_line);
+		}
+
+		static constexpr size_t inner_bytes(size_t capacity) noexcept
+		{
+			size_t bytes = align_up(sizeof(node_base), alignof(K)) + capacity * sizeof(K);
+			bytes = align_up(bytes, alignof(void*)) + (capacity + 1) * sizeof(void*);
+
+			return align_up(bytes, cache_line);
+		}
+
+		static constexpr size_t fit_leaf() noexcept
+		{
+			size_t capacity = NodeBytes / (sizeof(K) + sizeof(T));
+			while (capacity > 4 && leaf_bytes(capacity) > NodeBytes) --capacity;
+
+			return std::max<size_t>(capacity, 4);
+		}
+
+		static constexpr size_t fit_inner() noexcept
+		{
+			size_t capacity = NodeBytes / (sizeof(K) + sizeof(void*));
+			while (capacity > 4 && inner_bytes(capacity) > NodeBytes) --capacity;
+
+			return std::max<size_t>(capacity, 4);
+		}
+
+	public:
+		static constexpr size_t leaf_capacity  = fit_leaf();
+		static constexpr size_t inner_capacity = fit_inner();
+
+	private:
+		static constexpr size_t min_leaf  = leaf_capacity / 2;
+		static constexpr size_t min_inner = (inner_capacity - 1) / 2;
+		static constexpr size_t max_depth = 64;
+
+		// Raw storage for up to N elements; only the first count of a node are alive, so
+		// allocating a node constructs nothing and K and T need no default constructor
+		template<class V, size_t N>
+		struct slots
+		{
+			alignas(V) unsigned char bytes[N * sizeof(V)];
+
+			V* data() noexcept { return std::launder(reinterpret_cast<V*>(bytes)); }
+			const V* data() const noexcept { return std::launder(reinterpret_cast<const V*>(bytes)); }
+
+			V& operator[](size_t i) noexcept { return data()[i]; }
+			const V& operator[](size_t i) const noexcept { return data()[i]; }
+		};
+
+		// Nodes start on a cache line so a NodeBytes node spans exactly NodeBytes / 64 lines
+		struct alignas(cache_line) leaf_node : node_base
+		{
+			leaf_node() : node_base(true) {}
+
+			leaf_node(const leaf_node&) = delete;
+			leaf_node& operator=(const leaf_node&) = delete;
+
+			~leaf_node()
+			{
+				std::destroy_n(keys.data(), this->count);
+				std::destroy_n(values.data(), this->count);
+			}
+
+			slots<K, leaf_capacity> keys;
+			slots<T, leaf_capacity> values;
+			leaf_node*              next = nullptr;
+			leaf_node*              prev = nullptr;
+		};
+
+		struct alignas(cache_line) inner_node : node_base
+		{
+			inner_node() : node_base(false) {}
+
+			inner_node(const inner_node&) = delete;
+			inner_node& operator=(const inner_node&) = delete;
+
+			~inner_node()
+			{
+				std::destroy_n(keys.data(), this->count);
+			}
+
+			slots<K, inner_capacity> keys;
+			node_base*               children[inner_capacity + 1];
+		};
+
+		static_assert(NodeBytes % cache_line == 0, "BPlusTree NodeBytes must be a whole number of cache lines");
+		static_assert(sizeof(leaf_node) <= NodeBytes, "BPlusTree NodeBytes is too small for four leaf entries");
+		static_assert(sizeof(inner_node) <= NodeBytes, "BPlusTree NodeBytes is too small for four inner keys");
+
+		struct path_entry
+		{
+			inner_node* node;
+			size_t      idx;
+		};
+
+	public:
+		using leaf_ptr       = leaf_node*;
+		using const_iterator = ConstBPlusTreeIterator<BPlusTree>;
+		using iterator       = BPlusTreeIterator<BPlusTree>;
+
+		friend const_iterator;
+
+	public:
+		BPlusTree()
+			: root_(nullptr), first_(nullptr), last_(nullptr), size_(0) {}
+
+		BPlusTree(const BPlusTree& other) : BPlusTree()
+		{
+			for (auto entry : other)
+				emplace(entry.key, entry.value);
+		}
+
+		BPlusTree(BPlusTree&& other) noexcept
+			: root_(other.root_), first_(other.first_), last_(other.last_), size_(other.size_)
+		{
+			other.root_ = nullptr;
+			other.first_ = other.last_ = nullptr;
+			other.size_ = 0;
+		}
+
+		BPlusTree& operator=(BPlusTree other) noexcept
+		{
+			std::swap(root_, other.root_);
+			std::swap(first_, other.first_);
+			std::swap(last_, other.last_);
+			std::swap(size_, other.size_);
+			return *this;
+		}
+
+		~BPlusTree()
+		{
+			clear();
+		}
+
+	public:
+		template<class Key, class... Args>
+		iterator emplace(Key&& key, Args&&... args)
+		{
+			K k(std::forward<Key>(key));
+			T value(std::forward<Args>(args)...);
+
+			if (!root_)
+				root_ = first_ = last_ = new leaf_node;
+
+			path_entry path[max_depth];
+			size_t     depth = 0;
+
+			node_base* n = root_;
+			while (!n->leaf)
+			{
+				inner_node* inner = as_inner(n);
+				size_t idx = upper_index(inner->keys.data(), inner->count, k);
+
+				path[depth++] = { inner, idx };
+				n = inner->children[idx];
+			}
+
+			leaf_node* leaf = as_leaf(n);
+			size_t pos = upper_index(leaf->keys.data(), leaf->count, k);
+
+			if (leaf->count < leaf_capacity)
+			{
+				insert_leaf(leaf, pos, std::move(k), std::move(value));
+				size_ += 1;
+				return iterator{ leaf, pos, this };
+			}
+
+			leaf_node* right = split_leaf(leaf);
+			leaf_node* target = leaf;
+
+			if (pos > leaf->count)
+			{
+				pos -= leaf->count;
+				target = right;
+			}
+
+			insert_leaf(target, pos, std::move(k), std::move(value));
+			insert_parent(path, depth, right->keys[0], right);
+			size_ += 1;
+
+			return iterator{ target, pos, this };
+		}
+
+		bool erase(const key_type& key)
+		{
+			if (!root_) return false;
+
+			path_entry path[max_depth];
+			size_t     depth = 0;
+
+			node_base* n = root_;
+			while (!n->leaf)
+			{
+				inner_node* inner = as_inner(n);
+				size_t idx = lower_index(inner->keys.data(), inner->count, key);
+
+				path[depth++] = { inner, idx };
+				n = inner->children[idx];
+			}
+
+			leaf_node* leaf = as_leaf(n);
+			size_t pos = lower_index(leaf->keys.data(), leaf->count, key);
+
+			// Equal keys may continue at the front of the next leaf
+			while (pos == leaf->count)
+			{
+				leaf = next_leaf(path, depth);
+				if (!leaf) return false;
+
+				pos = lower_index(leaf->keys.data(), leaf->count, key);
+			}
+
+			if (key < leaf->keys[pos]) return false;
+
+			erase_slot(leaf->keys.data(), leaf->count, pos);
+			erase_slot(leaf->values.data(), leaf->count, pos);
+			leaf->count -= 1;
+			size_ -= 1;
+
+			rebalance_leaf(leaf, path, depth);
+			return true;
+		}
+
+		void clear()
+		{
+			destroy(root_);
+			root_ = nullptr;
+			first_ = last_ = nullptr;
+			size_ = 0;
+		}
+
+		size_t size() const
+		{
+			return size_;
+		}
+
+		bool empty() const noexcept
+		{
+			return size_ == 0;
+		}
+
+		void for_each(std::function<void(const key_type&, reference)> f)
+		{
+			for (leaf_node* leaf = first_; leaf; leaf = leaf->next)
+				for (size_t i = 0; i < leaf->count; ++i)
+					f(leaf->keys[i], leaf->values[i]);
+		}
+
+		void for_each(std::function<void(const key_type&, const_reference)> f) const
+		{
+			for (const leaf_node* leaf = first_; leaf; leaf = leaf->next)
+				for (size_t i = 0; i < leaf->count; ++i)
+					f(leaf->keys[i], leaf->values[i]);
+		}
+
+		[[nodiscard]] iterator find(const key_type& key) noexcept
+		{
+			iterator it = lower_bound(key);
+			return it != end() && !(key < it->key) ? it : end();
+		}
+
+		[[nodiscard]] const_iterator find(const key_type& key) const noexcept
+		{
+			const_iterator it = lower_bound(key);
+			return it != end() && !(key < it->key) ? it : end();
+		}
+
+		[[nodiscard]] bool contains(const key_type& key) const noexcept
+		{
+			return find(key) != end();
+		}
+
+		[[nodiscard]] iterator lower_bound(const key_type& key) noexcept
+		{
+			auto [leaf, pos] = bound<false>(key);
+			return iterator{ leaf, pos, this };
+		}
+
+		[[nodiscard]] const_iterator lower_bound(const key_type& key) const noexcept
+		{
+			auto [leaf, pos] = bound<false>(key);
+			return const_iterator{ leaf, pos, this };
+		}
+
+		[[nodiscard]] iterator upper_bound(const key_type& key) noexcept
+		{
+			auto [leaf, pos] = bound<true>(key);
+			return iterator{ leaf, pos, this };
+		}
+
+		[[nodiscard]] const_iterator upper_bound(const key_type& key) const noexcept
+		{
+			auto [leaf, pos] = bound<true>(key);
+			return const_iterator{ leaf, pos, this };
+		}
+
+		[[nodiscard]] std::pair<iterator, iterator> equal_range(const key_type& key) noexcept
+		{
+			return { lower_bound(key), upper_bound(key) };
+		}
+
+		[[nodiscard]] std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const noexcept
+		{
+			return { lower_bound(key), upper_bound(key) };
+		}
+
+	private:
+		static leaf_node* as_leaf(node_base* n) noexcept
+		{
+			return static_cast<leaf_node*>(n);
+		}
+
+		static inner_node* as_inner(node_base* n) noexcept
+		{
+			return static_cast<inner_node*>(n);
+		}
+
+		// Branchless binary search: the loop body compiles to a conditional move
+		static size_t lower_index(const K* keys, size_t n, const K& key) noexcept
+		{
+			if (n == 0) return 0;
+
+			const K* base = keys;
+			while (n > 1)
+			{
+				size_t half = n / 2;
+				base = base[half] < key ? base + half : base;
+				n -= half;
+			}
+
+			return (base - keys) + (*base < key);
+		}
+
+		static size_t upper_index(const K* keys, size_t n, const K& key) noexcept
+		{
+			if (n == 0) return 0;
+
+			const K* base = keys;
+			while (n > 1)
+			{
+				size_t half = n / 2;
+				base = key < base[half] ? base : base + half;
+				n -= half;
+			}
+
+			return (base - keys) + !(key < *base);
+		}
+
+		template<bool Upper>
+		std::pair<leaf_node*, size_t> bound(const key_type& key) const noexcept
+		{
+			if (!root_) return { nullptr, 0 };
+
+			node_base* n = root_;
+			while (!n->leaf)
+			{
+				inner_node* inner = as_inner(n);
+				n = inner->children[Upper ? upper_index(inner->keys.data(), inner->count, key) : lower_index(inner->keys.data(), inner->count, key)];
+			}
+
+			leaf_node* leaf = as_leaf(n);
+			size_t pos = Upper ? upper_index(leaf->keys.data(), leaf->count, key) : lower_index(leaf->keys.data(), leaf->count, key);
+
+			if (pos == leaf->count)
+				return { leaf->next, 0 };
+
+			return { leaf, pos };
+		}
+
+		// Puts value at pos of the count live slots at p, shifting the rest up into slot count
+		template<class V, class U>
+		static void insert_slot(V* p, size_t count, size_t pos, U&& value)
+		{
+			if (pos == count)
+			{
+				::new (static_cast<void*>(p + count)) V(std::forward<U>(value));
+				return;
+			}
+
+			::new (static_cast<void*>(p + count)) V(std::move(p[count - 1]));
+			std::move_backward(p + pos, p + count - 1, p + count);
+			p[pos] = std::forward<U>(value);
+		}
+
+		// Removes slot pos of the count live slots at p; slot count - 1 ends up raw
+		template<class V>
+		static void erase_slot(V* p, size_t count, size_t pos)
+		{
+			std::move(p + pos + 1, p + count, p + pos);
+			std::destroy_at(p + count - 1);
+		}
+
+		// Moves n live slots into raw storage at to and leaves them raw at from
+		template<class V>
+		static void relocate_slots(V* from, size_t n, V* to)
+		{
+			std::uninitialized_move_n(from, n, to);
+			std::destroy_n(from, n);
+		}
+
+		static void insert_leaf(leaf_node* leaf, size_t pos, K&& key, T&& value)
+		{
+			insert_slot(leaf->keys.data(), leaf->count, pos, std::move(key));
+			insert_slot(leaf->values.data(), leaf->count, pos, std::move(value));
+			leaf->count += 1;
+		}
+
+		static void insert_inner(inner_node* inner, size_t idx, const K& key, node_base* child)
+		{
+			insert_slot(inner->keys.data(), inner->count, idx, key);
+			std::move_backward(inner->children + idx + 1, inner->children + inner->count + 1, inner->children + inner->count + 2);
+
+			inner->children[idx + 1] = child;
+			inner->count += 1;
+		}
+
+		static void remove_inner(inner_node* inner, size_t key_idx, size_t child_idx)
+		{
+			erase_slot(inner->keys.data(), inner->count, key_idx);
+			std::move(inner->children + child_idx + 1, inner->children + inner->count + 1, inner->children + child_idx);
+			inner->count -= 1;
+		}
+
+		leaf_node* split_leaf(leaf_node* leaf)
+		{
+			leaf_node* right = new leaf_node;
+			size_t mid = leaf_capacity / 2;
+
+			relocate_slots(leaf->keys.data() + mid, leaf->count - mid, right->keys.data());
+			relocate_slots(leaf->values.data() + mid, leaf->count - mid, right->values.data());
+			right->count = leaf->count - mid;
+			leaf->count = mid;
+
+			right->prev = leaf;
+			right->next = leaf->next;
+			if (leaf->next) leaf->next->prev = right;
+			else last_ = right;
+			leaf->next = right;
+
+			return right;
+		}
+
+		void unlink_leaf(leaf_node* leaf) noexcept
+		{
+			if (leaf->prev) leaf->prev->next = leaf->next;
+			else first_ = leaf->next;
+
+			if (leaf->next) leaf->next->prev = leaf->prev;
+			else last_ = leaf->prev;
+
+			delete leaf;
+		}
+
+		void insert_parent(path_entry* path, size_t depth, K up, node_base* right)
+		{
+			while (depth > 0)
+			{
+				path_entry entry = path[--depth];
+				inner_node* inner = entry.node;
+
+				if (inner->count < inner_capacity)
+				{
+					insert_inner(inner, entry.idx, up, right);
+					return;
+				}
+
+				inner_node* sibling = new inner_node;
+				size_t mid = inner_capacity / 2;
+				K next_up = std::move(inner->keys[mid]);
+
+				relocate_slots(inner->keys.data() + mid + 1, inner->count - mid - 1, sibling->keys.data());
+				std::destroy_at(inner->keys.data() + mid);
+				std::move(inner->children + mid + 1, inner->children + inner->count + 1, sibling->children);
+				sibling->count = inner->count - mid - 1;
+				inner->count = mid;
+
+				if (entry.idx <= mid)
+					insert_inner(inner, entry.idx, up, right);
+				else
+					insert_inner(sibling, entry.idx - mid - 1, up, right);
+
+				up = std::move(next_up);
+				right = sibling;
+			}
+
+			inner_node* root = new inner_node;
+			::new (static_cast<void*>(root->keys.data())) K(std::move(up));
+			root->children[0] = root_;
+			root->children[1] = right;
+			root->count = 1;
+			root_ = root;
+		}
+
+		static leaf_node* next_leaf(path_entry* path, size_t& depth) noexcept
+		{
+			while (depth > 0 && path[depth - 1].idx == path[depth - 1].node->count)
+				depth -= 1;
+
+			if (depth == 0) return nullptr;
+
+			path_entry& entry = path[depth - 1];
+			node_base* n = entry.node->children[++entry.idx];
+
+			while (!n->leaf)
+			{
+				path[depth++] = { as_inner(n), 0 };
+				n = as_inner(n)->children[0];
+			}
+
+			return as_leaf(n);
+		}
+
+		void rebalance_leaf(leaf_node* leaf, path_entry* path, size_t depth)
+		{
+			if (depth == 0)
+			{
+				if (leaf->count == 0)
+				{
+					delete leaf;
+					root_ = first_ = last_ = nullptr;
+				}
+
+				return;
+			}
+
+			if (leaf->count >= min_leaf) return;
+
+			auto [parent, idx] = path[depth - 1];
+
+			if (idx > 0)
+			{
+				leaf_node* left = as_leaf(parent->children[idx - 1]);
+
+				if (left->count > min_leaf)
+				{
+					size_t last = left->count - 1;
+					insert_leaf(leaf, 0, std::move(left->keys[last]), std::move(left->values[last]));
+					std::destroy_at(left->keys.data() + last);
+					std::destroy_at(left->values.data() + last);
+					left->count = last;
+
+					parent->keys[idx - 1] = leaf->keys[0];
+					return;
+				}
+
+				relocate_slots(leaf->keys.data(), leaf->count, left->keys.data() + left->count);
+				relocate_slots(leaf->values.data(), leaf->count, left->values.data() + left->count);
+				left->count += leaf->count;
+				leaf->count = 0;
+
+				unlink_leaf(leaf);
+				remove_inner(parent, idx - 1, idx);
+			}
+			else
+			{
+				leaf_node* right = as_leaf(parent->children[idx + 1]);
+
+				if (right->count > min_leaf)
+				{
+					insert_leaf(leaf, leaf->count, std::move(right->keys[0]), std::move(right->values[0]));
+					erase_slot(right->keys.data(), right->count, 0);
+					erase_slot(right->values.data(), right->count, 0);
+					right->count -= 1;
+					parent->keys[idx] = right->keys[0];
+					return;
+				}
+
+				relocate_slots(right->keys.data(), right->count, leaf->keys.data() + leaf->count);
+				relocate_slots(right->values.data(), right->count, leaf->values.data() + leaf->count);
+				leaf->count += right->count;
+				right->count = 0;
+
+				unlink_leaf(right);
+				remove_inner(parent, idx, idx + 1);
+			}
+
+			rebalance_inner(path, depth - 1);
+		}
+
+		void rebalance_inner(path_entry* path, size_t depth)
+		{
+			for (;; --depth)
+			{
+				inner_node* inner = path[depth].node;
+
+				if (depth == 0)
+				{
+					if (inner->count == 0)
+					{
+						root_ = inner->children[0];
+						delete inner;
+					}
+
+					return;
+				}
+
+				if (inner->count >= min_inner) return;
+
+				auto [parent, idx] = path[depth - 1];
+
+				if (idx > 0)
+				{
+					inner_node* left = as_inner(parent->children[idx - 1]);
+
+					if (left->count > min_inner)
+					{
+						insert_slot(inner->keys.data(), inner->count, 0, std::move(parent->keys[idx - 1]));
+						std::move_backward(inner->children, inner->children + inner->count + 1, inner->children + inner->count + 2);
+
+						inner->children[0] = left->children[left->count];
+						parent->keys[idx - 1] = std::move(left->keys[left->count - 1]);
+						std::destroy_at(left->keys.data() + (left->count - 1));
+						left->count -= 1;
+						inner->count += 1;
+						return;
+					}
+
+					::new (static_cast<void*>(left->keys.data() + left->count)) K(std::move(parent->keys[idx - 1]));
+					relocate_slots(inner->keys.data(), inner->count, left->keys.data() + left->count + 1);
+					std::move(inner->children, inner->children + inner->count + 1, left->children + left->count + 1);
+					left->count += inner->count + 1;
+					inner->count = 0;
+
+					delete inner;
+					remove_inner(parent, idx - 1, idx);
+				}
+				else
+				{
+					inner_node* right = as_inner(parent->children[idx + 1]);
+
+					if (right->count > min_inner)
+					{
+						::new (static_cast<void*>(inner->keys.data() + inner->count)) K(std::move(parent->keys[idx]));
+						inner->children[inner->count + 1] = right->children[0];
+						parent->keys[idx] = std::move(right->keys[0]);
+						inner->count += 1;
+
+						erase_slot(right->keys.data(), right->count, 0);
+						std::move(right->children + 1, right->children + right->count + 1, right->children);
+						right->count -= 1;
+						return;
+					}
+
+					::new (static_cast<void*>(inner->keys.data() + inner->count)) K(std::move(parent->keys[idx]));
+					relocate_slots(right->keys.data(), right->count, inner->keys.data() + inner->count + 1);
+					std::move(right->children, right->children + right->count + 1, inner->children + inner->count + 1);
+					inner->count += right->count + 1;
+					right->count = 0;
+
+					delete right;
+					remove_inner(parent, idx, idx + 1);
+				}
+			}
+		}
+
+		static void destroy(node_base* n)
+		{
+			if (!n) return;
+
+			if (n->leaf)
+			{
+				delete as_leaf(n);
+				return;
+			}
+
+			inner_node* inner = as_inner(n);
+			for (size_t i = 0; i <= inner->count; ++i)
+				destroy(inner->children[i]);
+
+			delete inner;
+		}
+
+	public:
+		[[nodiscard]] iterator begin() noexcept
+		{
+			return iterator{ first_, 0, this };
+		}
+
+		[[nodiscard]] const_iterator cbegin() const noexcept
+		{
+			return const_iterator{ first_, 0, this };
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return iterator{ nullptr, 0, this };
+		}
+
+		[[nodiscard]] const_iterator cend() const noexcept
+		{
+			return const_iterator{ nullptr, 0, this };
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return cbegin();
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return cend();
+		}
+
+	private:
+		node_base* root_;
+		leaf_node* first_;
+		leaf_node* last_;
+		size_t     size_;
+	};
+}
@@ -0,0 +1,456 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace ist
+{
+	static constexpr size_t cache_line_size = 64;
+
+	enum class wait_mode
+	{
+		spin,
+		yield,
+		block
+	};
+
+	inline void cpu_relax() noexcept
+	{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+		_mm_pause();
+#endif
+	}
+
+	class QueueWaiter
+	{
+	public:
+		QueueWaiter() : waiters_(0), epoch_(0) {}
+
+		// try_fn runs outside the mutex, so it may notify other waiters itself
+		template<class TryFn>
+		void wait(TryFn try_fn, wait_mode mode)
+		{
+			for (size_t spins = 0; ; ++spins)
+			{
+				size_t epoch = epoch_.load(std::memory_order_acquire);
+
+				if (mode == wait_mode::block && spins >= spin_limit)
+				{
+					waiters_.fetch_add(1, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+				}
+
+				if (try_fn())
+				{
+					if (mode == wait_mode::block && spins >= spin_limit)
+						waiters_.fetch_sub(1, std::memory_order_relaxed);
+
+					return;
+				}
+
+				if (mode == wait_mode::spin || spins < spin_limit)
+				{
+					cpu_relax();
+				}
+				else if (mode == wait_mode::yield)
+				{
+					std::this_thread::yield();
+				}
+				else
+				{
+					std::unique_lock<std::mutex> lock(mutex_);
+					while (epoch_.load(std::memory_order_relaxed) == epoch)
+						cv_.wait(lock);
+
+					waiters_.fetch_sub(1, std::memory_order_relaxed);
+				}
+			}
+		}
+
+		void notify()
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (waiters_.load(std::memory_order_relaxed) == 0) return;
+
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				epoch_.fetch_add(1, std::memory_order_release);
+			}
+
+			cv_.notify_all();
+		}
+
+	private:
+		static constexpr size_t spin_limit = 128;
+
+		std::atomic<size_t>     waiters_;
+		std::atomic<size_t>     epoch_;
+		std::mutex              mutex_;
+		std::condition_variable cv_;
+	};
+
+	struct MpscNode
+	{
+		std::atomic<MpscNode*> next{ nullptr };
+	};
+
+	template<class T>
+	class MpscQueue
+	{
+		static_assert(std::is_base_of<MpscNode, T>::value, "MpscQueue elements must derive from MpscNode");
+
+	public:
+		using value_type = T;
+		using node_ptr   = MpscNode*;
+
+	public:
+		MpscQueue() : head_(&stub_), tail_(&stub_) {}
+
+		MpscQueue(const MpscQueue&) = delete;
+		MpscQueue& operator=(const MpscQueue&) = delete;
+
+	public:
+		void push(value_type* value)
+		{
+			push_chain(value, value);
+			waiter_.notify();
+		}
+
+		template<class Iter>
+		void push_bulk(Iter first, Iter last)
+		{
+			if (first == last) return;
+
+			node_ptr chain_first = *first;
+			node_ptr chain_last  = chain_first;
+
+			for (++first; first != last; ++first)
+			{
+				node_ptr next = *first;
+				chain_last->next.store(next, std::memory_order_relaxed);
+				chain_last = next;
+			}
+
+			push_chain(chain_first, chain_last);
+			waiter_.notify();
+		}
+
+		// Single consumer only
+		value_type* try_pop()
+		{
+			node_ptr tail = tail_;
+			node_ptr next = tail->next.load(std::memory_order_acquire);
+
+			if (tail == &stub_)
+			{
+				if (!next) return nullptr;
+
+				tail_ = next;
+				tail = next;
+				next = next->next.load(std::memory_order_acquire);
+			}
+
+			if (next)
+			{
+				tail_ = next;
+				return static_cast<value_type*>(tail);
+			}
+
+			// A producer has swapped head_ but not linked its node yet
+			if (tail != head_.load(std::memory_order_acquire))
+				return nullptr;
+
+			push_chain(&stub_, &stub_);
+
+			next = tail->next.load(std::memory_order_acquire);
+			if (next)
+			{
+				tail_ = next;
+				return static_cast<value_type*>(tail);
+			}
+
+			return nullptr;
+		}
+
+		template<class OutIter>
+		size_t try_pop_bulk(OutIter out, size_t max_count)
+		{
+			size_t count = 0;
+
+			for (; count < max_count; ++count)
+			{
+				value_type* value = try_pop();
+				if (!value) break;
+
+				*out = value;
+				++out;
+			}
+
+			return count;
+		}
+
+		value_type* pop(wait_mode mode = wait_mode::block)
+		{
+			value_type* value = nullptr;
+			waiter_.wait([this, &value] { return (value = try_pop()) != nullptr; }, mode);
+			return value;
+		}
+
+		bool empty() const noexcept
+		{
+			return tail_ == &stub_ && !stub_.next.load(std::memory_order_acquire)
+				&& head_.load(std::memory_order_acquire) == &stub_;
+		}
+
+	private:
+		void push_chain(node_ptr first, node_ptr last)
+		{
+			last->next.store(nullptr, std::memory_order_relaxed);
+			node_ptr prev = head_.exchange(last, std::memory_order_acq_rel);
+			prev->next.store(first, std::memory_order_release);
+		}
+
+	private:
+		alignas(cache_line_size) std::atomic<node_ptr> head_;
+		alignas(cache_line_size) node_ptr              tail_;
+		MpscNode                                       stub_;
+		QueueWaiter                                    waiter_;
+	};
+
+	template<class T>
+	class MpmcQueue
+	{
+	private:
+		struct cell
+		{
+			std::atomic<size_t> sequence;
+			alignas(T) unsigned char storage[sizeof(T)];
+
+			T* data() noexcept
+			{
+				return std::launder(reinterpret_cast<T*>(storage));
+			}
+		};
+
+	public:
+		using value_type = T;
+
+	public:
+		explicit MpmcQueue(size_t capacity)
+			: cells_(new cell[capacity]), mask_(capacity - 1)
+		{
+			assert(capacity >= 2 && (capacity & (capacity - 1)) == 0 && "MpmcQueue capacity must be a power of two");
+
+			for (size_t i = 0; i < capacity; ++i)
+				cells_[i].sequence.store(i, std::memory_order_relaxed);
+
+			enqueue_pos_.store(0, std::memory_order_relaxed);
+			dequeue_pos_.store(0, std::memory_order_relaxed);
+		}
+
+		MpmcQueue(const MpmcQueue&) = delete;
+		MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+		~MpmcQueue()
+		{
+			value_type value;
+			while (try_pop(value)) {}
+		}
+
+	public:
+		template<class... Args>
+		bool try_emplace(Args&&... args)
+		{
+			size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+
+			for (;;)
+			{
+				cell& c = cells_[pos & mask_];
+				size_t seq = c.sequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+
+				if (diff == 0)
+				{
+					if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = enqueue_pos_.load(std::memory_order_relaxed);
+				}
+			}
+
+			publish(pos, std::forward<Args>(args)...);
+			not_empty_.notify();
+			return true;
+		}
+
+		bool try_push(const value_type& value)
+		{
+			return try_emplace(value);
+		}
+
+		bool try_push(value_type&& value)
+		{
+			return try_emplace(std::move(value));
+		}
+
+		bool try_pop(value_type& value)
+		{
+			size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+
+			for (;;)
+			{
+				cell& c = cells_[pos & mask_];
+				size_t seq = c.sequence.load(std::memory_order_acquire);
+				intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+
+				if (diff == 0)
+				{
+					if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = dequeue_pos_.load(std::memory_order_relaxed);
+				}
+			}
+
+			consume(pos, value);
+			not_full_.notify();
+			return true;
+		}
+
+		// Claims a run of free cells with one CAS; returns how many were pushed
+		template<class Iter>
+		size_t try_push_bulk(Iter first, size_t count)
+		{
+			size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+			size_t claimed = 0;
+
+			for (;;)
+			{
+				claimed = 0;
+				while (claimed < count && cells_[(pos + claimed) & mask_].sequence.load(std::memory_order_acquire) == pos + claimed)
+					claimed += 1;
+
+				if (claimed == 0)
+				{
+					size_t current = enqueue_pos_.load(std::memory_order_relaxed);
+					if (current == pos) return 0;
+
+					pos = current;
+					continue;
+				}
+
+				if (enqueue_pos_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed))
+					break;
+			}
+
+			for (size_t i = 0; i < claimed; ++i, ++first)
+				publish(pos + i, *first);
+
+			not_empty_.notify();
+			return claimed;
+		}
+
+		template<class OutIter>
+		size_t try_pop_bulk(OutIter out, size_t max_count)
+		{
+			size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+			size_t claimed = 0;
+
+			for (;;)
+			{
+				claimed = 0;
+				while (claimed < max_count && cells_[(pos + claimed) & mask_].sequence.load(std::memory_order_acquire) == pos + claimed + 1)
+					claimed += 1;
+
+				if (claimed == 0)
+				{
+					size_t current = dequeue_pos_.load(std::memory_order_relaxed);
+					if (current == pos) return 0;
+
+					pos = current;
+					continue;
+				}
+
+				if (dequeue_pos_.compare_exchange_weak(pos, pos + claimed, std::memory_order_relaxed))
+					break;
+			}
+
+			for (size_t i = 0; i < claimed; ++i, ++out)
+			{
+				value_type value;
+				consume(pos + i, value);
+				*out = std::move(value);
+			}
+
+			not_full_.notify();
+			return claimed;
+		}
+
+		void push(const value_type& value, wait_mode mode = wait_mode::block)
+		{
+			not_full_.wait([this, &value] { return try_push(value); }, mode);
+		}
+
+		void push(value_type&& value, wait_mode mode = wait_mode::block)
+		{
+			not_full_.wait([this, &value] { return try_push(std::move(value)); }, mode);
+		}
+
+		value_type pop(wait_mode mode = wait_mode::block)
+		{
+			value_type value;
+			not_empty_.wait([this, &value] { return try_pop(value); }, mode);
+			return value;
+		}
+
+		size_t capacity() const noexcept { return mask_ + 1; }
+
+	private:
+		template<class... Args>
+		void publish(size_t pos, Args&&... args)
+		{
+			cell& c = cells_[pos & mask_];
+			::new (static_cast<void*>(c.storage)) value_type(std::forward<Args>(args)...);
+			c.sequence.store(pos + 1, std::memory_order_release);
+		}
+
+		void consume(size_t pos, value_type& value)
+		{
+			cell& c = cells_[pos & mask_];
+			value = std::move(*c.data());
+			std::destroy_at(c.data());
+			c.sequence.store(pos + mask_ + 1, std::memory_order_release);
+		}
+
+	private:
+		std::unique_ptr<cell[]>                           cells_;
+		size_t                                            mask_;
+		alignas(cache_line_size) std::atomic<size_t>      enqueue_pos_;
+		alignas(cache_line_size) std::atomic<size_t>      dequeue_pos_;
+		alignas(cache_line_size) QueueWaiter              not_empty_;
+		QueueWaiter                                       not_full_;
+	};
+}
@@ -0,0 +1,353 @@
+#pragma once
+#include "my_loser_tree.h"
+#include "my_sort.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ist
+{
+	struct ExternalSortOptions
+	{
+		// Memory budget for sort chunks and merge buffers together
+		size_t memory_bytes = size_t(256) << 20;
+
+		// Smallest read buffer per run; more runs than the budget allows at this size are merged in several passes
+		size_t min_run_buffer_bytes = size_t(1) << 20;
+
+		// Overlap file reads and writes with sorting and merging on helper threads
+		bool background_io = true;
+	};
+
+	using ExternalFile = std::unique_ptr<std::FILE, int(*)(std::FILE*)>;
+
+	inline ExternalFile open_external_file(const char* path, const char* mode)
+	{
+		ExternalFile file(std::fopen(path, mode), &std::fclose);
+		if (!file) throw std::runtime_error(std::string("external_sort: cannot open ") + path);
+
+		return file;
+	}
+
+	inline ExternalFile open_temp_file()
+	{
+		ExternalFile file(std::tmpfile(), &std::fclose);
+		if (!file) throw std::runtime_error("external_sort: cannot create a temporary run file");
+
+		return file;
+	}
+
+	// Records left in a seekable file, or SIZE_MAX when the size cannot be told (pipes, or past long on some platforms)
+	inline size_t external_file_records(std::FILE* file, size_t record_size)
+	{
+		long start = std::ftell(file);
+		if (start < 0 || std::fseek(file, 0, SEEK_END) != 0) return SIZE_MAX;
+
+		long end = std::ftell(file);
+		if (std::fseek(file, start, SEEK_SET) != 0)
+			throw std::runtime_error("external_sort: seek failed");
+
+		return end < start ? SIZE_MAX : static_cast<size_t>(end - start) / record_size;
+	}
+
+	template<class T>
+	void write_records(std::FILE* file, const T* data, size_t count)
+	{
+		if (std::fwrite(data, sizeof(T), count, file) != count)
+			throw std::runtime_error("external_sort: write failed");
+	}
+
+	// Sequential reader over a file of T; with read_ahead the next block loads on a helper thread
+	template<class T>
+	class RecordReader
+	{
+	public:
+		RecordReader(std::FILE* file, size_t capacity, bool read_ahead)
+			: file_(file), current_(std::max<size_t>(capacity, 1)), next_(read_ahead ? current_.size() : 0),
+			  pos_(0), size_(0), read_ahead_(read_ahead)
+		{
+			size_ = read_block(current_);
+			if (read_ahead_ && size_ == current_.size()) start_read_ahead();
+		}
+
+		RecordReader(const RecordReader&) = delete;
+		RecordReader& operator=(const RecordReader&) = delete;
+
+		~RecordReader()
+		{
+			if (pending_.valid()) pending_.wait();
+		}
+
+		bool empty() const noexcept
+		{
+			return pos_ == size_;
+		}
+
+		const T& front() const noexcept
+		{
+			return current_[pos_];
+		}
+
+		void pop()
+		{
+			if (++pos_ < size_) return;
+
+			bool full = size_ == current_.size();
+			pos_ = 0;
+			size_ = 0;
+
+			if (!full) return;
+
+			if (pending_.valid())
+			{
+				size_ = pending_.get();
+				std::swap(current_, next_);
+
+				if (size_ == current_.size()) start_read_ahead();
+			}
+			else if (!read_ahead_)
+			{
+				size_ = read_block(current_);
+			}
+		}
+
+	private:
+		size_t read_block(std::vector<T>& block)
+		{
+			size_t count = std::fread(block.data(), sizeof(T), block.size(), file_);
+			if (count < block.size() && std::ferror(file_))
+				throw std::runtime_error("external_sort: read failed");
+
+			return count;
+		}
+
+		void start_read_ahead()
+		{
+			pending_ = std::async(std::launch::async, [this] { return read_block(next_); });
+		}
+
+	private:
+		std::FILE*          file_;
+		std::vector<T>      current_;
+		std::vector<T>      next_;
+		size_t              pos_;
+		size_t              size_;
+		bool                read_ahead_;
+		std::future<size_t> pending_;
+	};
+
+	// Buffered writer; with write_behind a full block is written on a helper thread
+	template<class T>
+	class RecordWriter
+	{
+	public:
+		RecordWriter(std::FILE* file, size_t capacity, bool write_behind)
+			: file_(file), capacity_(std::max<size_t>(capacity, 1)), write_behind_(write_behind)
+		{
+			current_.reserve(capacity_);
+			if (write_behind_) flushing_.reserve(capacity_);
+		}
+
+		RecordWriter(const RecordWriter&) = delete;
+		RecordWriter& operator=(const RecordWriter&) = delete;
+
+		~RecordWriter()
+		{
+			if (pending_.valid()) pending_.wait();
+		}
+
+		void push(const T& value)
+		{
+			current_.push_back(value);
+			if (current_.size() == capacity_) flush_block();
+		}
+
+		void finish()
+		{
+			if (pending_.valid()) pending_.get();
+
+			write_records(file_, current_.data(), current_.size());
+			current_.clear();
+
+			if (std::fflush(file_) != 0)
+				throw std::runtime_error("external_sort: write failed");
+		}
+
+	private:
+		void flush_block()
+		{
+			if (!write_behind_)
+			{
+				write_records(file_, current_.data(), current_.size());
+				current_.clear();
+				return;
+			}
+
+			if (pending_.valid()) pending_.get();
+
+			std::swap(current_, flushing_);
+			current_.clear();
+
+			pending_ = std::async(std::launch::async, [this] { write_records(file_, flushing_.data(), flushing_.size()); });
+		}
+
+	private:
+		std::FILE*        file_;
+		size_t            capacity_;
+		bool              write_behind_;
+		std::vector<T>    current_;
+		std::vector<T>    flushing_;
+		std::future<void> pending_;
+	};
+
+	// Merges sorted runs into out through a loser tree; ties go to the earlier run, so
+	// merging runs in input order keeps a stable comparator stable
+	template<class T, class Cmp>
+	void merge_external_runs(std::vector<std::FILE*>& runs, std::FILE* out, size_t buffer_records, Cmp cmp, bool background_io)
+	{
+		// A deque never relocates readers, whose read-ahead threads hold on to them
+		std::deque<RecordReader<T>> readers;
+
+		for (std::FILE* run : runs)
+		{
+			std::rewind(run);
+			readers.emplace_back(run, buffer_records, background_io);
+		}
+
+		LoserTree<std::deque<RecordReader<T>>, Cmp> tree(readers, cmp);
+		RecordWriter<T> writer(out, buffer_records, background_io);
+
+		for (; !tree.empty(); tree.pop())
+			writer.push(tree.front());
+
+		writer.finish();
+	}
+
+	// Sorts a file of fixed-size records that may be far larger than memory: sorted runs of
+	// memory-sized chunks go to temporary files, then k-way merges combine them. Returns the record count.
+	template<class T, class Cmp = std::less_equal<>>
+	size_t external_sort(const std::string& input_path, const std::string& output_path, Cmp cmp = std::less_equal<>(),
+		const ExternalSortOptions& options = ExternalSortOptions())
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "external_sort works on raw fixed-size records");
+
+		ExternalFile input = open_external_file(input_path.c_str(), "rb");
+
+		// A chunk needs half its size again as merge scratch, plus a second chunk being written behind
+		const double chunk_share = options.background_io ? 2.5 : 1.5;
+		size_t chunk = std::max<size_t>(static_cast<size_t>(options.memory_bytes / chunk_share) / sizeof(T), 1);
+
+		// Small inputs only pay for their own size; the spare record lets a file that fits exactly take the one-chunk path
+		size_t records = external_file_records(input.get(), sizeof(T));
+		if (records < chunk) chunk = records + 1;
+
+		std::vector<T> data(chunk);
+		std::vector<T> writing(options.background_io ? chunk : 0);
+		std::vector<T> scratch(merge_sort_buffer_size(chunk));
+
+		std::vector<ExternalFile> runs;
+		std::future<void> pending;
+		size_t total = 0;
+
+		for (;;)
+		{
+			size_t count = std::fread(data.data(), sizeof(T), chunk, input.get());
+			if (count < chunk && std::ferror(input.get()))
+				throw std::runtime_error("external_sort: read failed");
+
+			if (count == 0) break;
+
+			total += count;
+			merge_sort_buffered(data.data(), data.data() + count, scratch.data(), cmp);
+
+			// Everything fit in one chunk: no runs needed
+			if (runs.empty() && count < chunk)
+			{
+				ExternalFile output = open_external_file(output_path.c_str(), "wb");
+				write_records(output.get(), data.data(), count);
+				return total;
+			}
+
+			runs.push_back(open_temp_file());
+			std::FILE* run = runs.back().get();
+
+			if (options.background_io)
+			{
+				if (pending.valid()) pending.get();
+
+				std::swap(data, writing);
+				pending = std::async(std::launch::async, [run, &writing, count] { write_records(run, writing.data(), count); });
+			}
+			else
+			{
+				write_records(run, data.data(), count);
+			}
+
+			if (count < chunk) break;
+		}
+
+		if (pending.valid()) pending.get();
+
+		data = std::vector<T>();
+		writing = std::vector<T>();
+		scratch = std::vector<T>();
+
+		ExternalFile output = open_external_file(output_path.c_str(), "wb");
+		if (runs.empty()) return 0;
+
+		// Each reader, and the writer, gets an equal share of the budget (two blocks each with background I/O)
+		const size_t blocks = options.background_io ? 2 : 1;
+		size_t fan_in = std::max<size_t>(options.memory_bytes / (options.min_run_buffer_bytes * blocks), 3) - 1;
+
+		while (runs.size() > 1)
+		{
+			bool last_pass = runs.size() <= fan_in;
+			std::vector<ExternalFile> merged;
+
+			for (size_t first = 0; first < runs.size(); first += fan_in)
+			{
+				size_t last = std::min(first + fan_in, runs.size());
+
+				std::vector<std::FILE*> group;
+				for (size_t i = first; i < last; ++i)
+					group.push_back(runs[i].get());
+
+				size_t buffer_records = std::max<size_t>(options.memory_bytes / ((group.size() + 1) * blocks * sizeof(T)), 1);
+
+				if (last_pass)
+				{
+					merge_external_runs<T>(group, output.get(), buffer_records, cmp, options.background_io);
+				}
+				else
+				{
+					merged.push_back(open_temp_file());
+					merge_external_runs<T>(group, merged.back().get(), buffer_records, cmp, options.background_io);
+				}
+
+				for (size_t i = first; i < last; ++i)
+					runs[i].reset();
+			}
+
+			if (last_pass) return total;
+
+			runs = std::move(merged);
+		}
+
+		// A single full-sized run
+		std::vector<std::FILE*> group{ runs.front().get() };
+		merge_external_runs<T>(group, output.get(), std::max<size_t>(options.memory_bytes / (2 * blocks * sizeof(T)), 1), cmp, options.background_io);
+
+		return total;
+	}
+}
@@ -0,0 +1,422 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__AVX2__) || defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace ist
+{
+	template<class K, class T>
+	struct FrozenTreeEntry
+	{
+		const K& key;
+		const T& value;
+	};
+
+	template<class Entry>
+	struct FrozenTreeArrow
+	{
+		Entry entry;
+
+		const Entry* operator->() const noexcept
+		{
+			return &entry;
+		}
+	};
+
+	// Walks the Eytzinger array in key order; index 0 is end()
+	template<class Tree>
+	class FrozenTreeIterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using difference_type   = ptrdiff_t;
+
+		using value_type = FrozenTreeEntry<typename Tree::key_type, typename Tree::value_type>;
+		using reference  = value_type;
+		using pointer    = FrozenTreeArrow<value_type>;
+
+		FrozenTreeIterator() noexcept : idx{}, tree{} {}
+
+		explicit FrozenTreeIterator(size_t idx, const Tree* tree) noexcept
+			: idx{ idx }, tree{ tree } {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return { tree->keys_[idx], tree->values_[idx - 1] };
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return { **this };
+		}
+
+		FrozenTreeIterator& operator++() noexcept
+		{
+			size_t n = tree->size_;
+
+			if (2 * idx + 1 <= n)
+			{
+				idx = 2 * idx + 1;
+				while (2 * idx <= n) idx = 2 * idx;
+			}
+			else
+			{
+				while (idx & 1) idx >>= 1;
+				idx >>= 1;
+			}
+
+			return *this;
+		}
+
+		FrozenTreeIterator operator++(int) noexcept
+		{
+			FrozenTreeIterator tmp = *this;
+			++* this;
+			return tmp;
+		}
+
+		FrozenTreeIterator& operator--() noexcept
+		{
+			size_t n = tree->size_;
+
+			if (idx == 0)
+			{
+				idx = 1;
+				while (2 * idx + 1 <= n) idx = 2 * idx + 1;
+			}
+			else if (2 * idx <= n)
+			{
+				idx = 2 * idx;
+				while (2 * idx + 1 <= n) idx = 2 * idx + 1;
+			}
+			else
+			{
+				while (idx > 1 && !(idx & 1)) idx >>= 1;
+				idx >>= 1;
+			}
+
+			return *this;
+		}
+
+		FrozenTreeIterator operator--(int) noexcept
+		{
+			FrozenTreeIterator tmp = *this;
+			--* this;
+			return tmp;
+		}
+
+		[[nodiscard]] bool operator==(const FrozenTreeIterator& other) const noexcept
+		{
+			return idx == other.idx;
+		}
+
+		[[nodiscard]] bool operator!=(const FrozenTreeIterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+		size_t      idx;
+		const Tree* tree;
+	};
+
+	// A read-only snapshot of sorted keys in Eytzinger (BFS) order: the first levels of every
+	// search share a few cache lines and the next levels can be prefetched ahead of the compare.
+	template<class K, class T>
+	class FrozenTree
+	{
+	public:
+		using key_type   = K;
+		using value_type = T;
+
+		using const_iterator = FrozenTreeIterator<FrozenTree>;
+		using iterator       = const_iterator;
+
+		friend const_iterator;
+
+	public:
+		FrozenTree() noexcept : size_(0), levels_(0) {}
+
+		// [first, first + n) must yield entries with ascending ->key and their ->value
+		template<class Iter>
+		FrozenTree(Iter first, size_t n)
+			: size_(n), levels_(0)
+		{
+			if (n == 0) return;
+
+			keys_.reserve(n + 1);
+			values_.reserve(n);
+
+			// Slot 0 is never searched; it only keeps the 1-based indices of the layout
+			keys_.push_back(first->key);
+			for (size_t i = 0; i < n; ++i)
+			{
+				keys_.push_back(first->key);
+				values_.push_back(first->value);
+			}
+
+			fill(first, 1);
+
+			while ((size_t(1) << levels_) <= n) ++levels_;
+		}
+
+	public:
+		[[nodiscard]] const_iterator lower_bound(const key_type& key) const noexcept
+		{
+			const key_type* keys = keys_.data();
+			size_t k = 1;
+
+			while (k <= size_)
+			{
+				prefetch(keys, k * prefetch_stride);
+				k = 2 * k + (keys[k] < key);
+			}
+
+			return const_iterator{ k >> (trailing_ones(k) + 1), this };
+		}
+
+		[[nodiscard]] const_iterator upper_bound(const key_type& key) const noexcept
+		{
+			const key_type* keys = keys_.data();
+			size_t k = 1;
+
+			while (k <= size_)
+			{
+				prefetch(keys, k * prefetch_stride);
+				k = 2 * k + !(key < keys[k]);
+			}
+
+			return const_iterator{ k >> (trailing_ones(k) + 1), this };
+		}
+
+		[[nodiscard]] const_iterator find(const key_type& key) const noexcept
+		{
+			const_iterator it = lower_bound(key);
+			return it.idx && !(key < keys_[it.idx]) ? it : end();
+		}
+
+		[[nodiscard]] bool contains(const key_type& key) const noexcept
+		{
+			return find(key) != end();
+		}
+
+		// Runs count searches in lockstep so their cache misses overlap. Every search takes
+		// exactly levels_ steps: a lane that falls off the tree early keeps turning right,
+		// which the final trailing-ones shift discards.
+		template<class OutIter>
+		void lower_bound_many(const key_type* queries, size_t count, OutIter out) const
+		{
+			size_t i = 0;
+
+#if defined(__AVX2__)
+			if constexpr (simd_keys)
+			{
+				// 32-bit lanes hold indices up to 2^(levels_ + 1)
+				if (sizeof(key_type) == 8 || size_ < (size_t(1) << 30))
+				{
+					for (; i + simd_lanes <= count; i += simd_lanes)
+						out = emit(simd_search(queries + i), simd_lanes, out);
+				}
+			}
+#endif
+
+			for (; i < count; i += batch_size)
+			{
+				size_t lanes = count - i < batch_size ? count - i : batch_size;
+				out = emit(batch_search(queries + i, lanes), lanes, out);
+			}
+		}
+
+		size_t size() const noexcept
+		{
+			return size_;
+		}
+
+		bool empty() const noexcept
+		{
+			return size_ == 0;
+		}
+
+	public:
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			size_t idx = size_ ? 1 : 0;
+			while (idx && 2 * idx <= size_) idx = 2 * idx;
+
+			return const_iterator{ idx, this };
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return const_iterator{ 0, this };
+		}
+
+	private:
+		static constexpr size_t cache_line = 64;
+		static constexpr size_t prefetch_stride = sizeof(key_type) < cache_line ? cache_line / sizeof(key_type) : 1;
+		static constexpr size_t batch_size = 8;
+
+		static constexpr bool simd_keys = std::is_integral<key_type>::value && !std::is_same<key_type, bool>::value
+			&& (sizeof(key_type) == 4 || sizeof(key_type) == 8);
+		static constexpr size_t simd_lanes = 32 / sizeof(key_type);
+
+		struct lanes_result
+		{
+			size_t idx[batch_size];
+		};
+
+		template<class Iter>
+		void fill(Iter& it, size_t k)
+		{
+			if (k > size_) return;
+
+			fill(it, 2 * k);
+
+			keys_[k] = it->key;
+			values_[k - 1] = it->value;
+			++it;
+
+			fill(it, 2 * k + 1);
+		}
+
+		static void prefetch(const key_type* keys, size_t idx) noexcept
+		{
+			// The address may lie past the array; prefetches never fault
+			const char* p = reinterpret_cast<const char*>(reinterpret_cast<std::uintptr_t>(keys) + idx * sizeof(key_type));
+
+#if defined(__GNUC__) || defined(__clang__)
+			__builtin_prefetch(p);
+#elif defined(_M_X64) || defined(_M_IX86)
+			_mm_prefetch(p, _MM_HINT_T0);
+#else
+			(void)p;
+#endif
+		}
+
+		static unsigned trailing_ones(size_t k) noexcept
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			return static_cast<unsigned>(__builtin_ctzll(~static_cast<unsigned long long>(k)));
+#elif defined(_MSC_VER) && defined(_M_X64)
+			unsigned long bit;
+			_BitScanForward64(&bit, ~static_cast<unsigned long long>(k));
+			return bit;
+#else
+			unsigned count = 0;
+			for (; k & 1; k >>= 1) ++count;
+			return count;
+#endif
+		}
+
+		template<class OutIter>
+		OutIter emit(const lanes_result& result, size_t lanes, OutIter out) const
+		{
+			for (size_t j = 0; j < lanes; ++j, ++out)
+			{
+				size_t k = result.idx[j];
+				*out = const_iterator{ k >> (trailing_ones(k) + 1), this };
+			}
+
+			return out;
+		}
+
+		lanes_result batch_search(const key_type* queries, size_t lanes) const noexcept
+		{
+			const key_type* keys = keys_.data();
+			lanes_result result;
+
+			for (size_t j = 0; j < lanes; ++j)
+				result.idx[j] = 1;
+
+			for (size_t level = 0; level < levels_; ++level)
+			{
+				for (size_t j = 0; j < lanes; ++j)
+				{
+					size_t k = result.idx[j];
+					prefetch(keys, k * prefetch_stride);
+					result.idx[j] = 2 * k + (k > size_ || keys[k] < queries[j]);
+				}
+			}
+
+			return result;
+		}
+
+#if defined(__AVX2__)
+		lanes_result simd_search(const key_type* queries) const noexcept
+		{
+			lanes_result result;
+
+			if constexpr (sizeof(key_type) == 4)
+			{
+				// Flipping the sign bit lets a signed compare order unsigned keys
+				const __m256i bias  = _mm256_set1_epi32(std::is_signed<key_type>::value ? 0 : INT32_MIN);
+				const __m256i bound = _mm256_set1_epi32(static_cast<int>(size_ + 1));
+				const __m256i one   = _mm256_set1_epi32(1);
+				const int*    base  = reinterpret_cast<const int*>(keys_.data());
+
+				__m256i q = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(queries)), bias);
+				__m256i k = one;
+
+				for (size_t level = 0; level < levels_; ++level)
+				{
+					__m256i inside = _mm256_cmpgt_epi32(bound, k);
+					__m256i key    = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), base, k, inside, 4);
+					__m256i less   = _mm256_cmpgt_epi32(q, _mm256_xor_si256(key, bias));
+					__m256i right  = _mm256_or_si256(less, _mm256_xor_si256(inside, _mm256_set1_epi32(-1)));
+
+					k = _mm256_sub_epi32(_mm256_slli_epi32(k, 1), right);
+				}
+
+				alignas(32) std::uint32_t idx[8];
+				_mm256_store_si256(reinterpret_cast<__m256i*>(idx), k);
+
+				for (size_t j = 0; j < 8; ++j)
+					result.idx[j] = idx[j];
+			}
+			else
+			{
+				const __m256i bias  = _mm256_set1_epi64x(std::is_signed<key_type>::value ? 0 : INT64_MIN);
+				const __m256i bound = _mm256_set1_epi64x(static_cast<long long>(size_ + 1));
+				const __m256i one   = _mm256_set1_epi64x(1);
+				const long long* base = reinterpret_cast<const long long*>(keys_.data());
+
+				__m256i q = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(queries)), bias);
+				__m256i k = one;
+
+				for (size_t level = 0; level < levels_; ++level)
+				{
+					__m256i inside = _mm256_cmpgt_epi64(bound, k);
+					__m256i key    = _mm256_mask_i64gather_epi64(_mm256_setzero_si256(), base, k, inside, 8);
+					__m256i less   = _mm256_cmpgt_epi64(q, _mm256_xor_si256(key, bias));
+					__m256i right  = _mm256_or_si256(less, _mm256_xor_si256(inside, _mm256_set1_epi64x(-1)));
+
+					k = _mm256_sub_epi64(_mm256_slli_epi64(k, 1), right);
+				}
+
+				alignas(32) std::uint64_t idx[4];
+				_mm256_store_si256(reinterpret_cast<__m256i*>(idx), k);
+
+				for (size_t j = 0; j < 4; ++j)
+					result.idx[j] = static_cast<size_t>(idx[j]);
+			}
+
+			return result;
+		}
+#endif
+
+	private:
+		std::vector<key_type>   keys_;
+		std::vector<value_type> values_;
+		size_t                  size_;
+		size_t                  levels_;
+	};
+}
@@ -1,6 +1,11 @@
 #pragma once
 #include <iostream>
+#include <atomic>
 #include <cassert>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -446,4 +451,250 @@ namespace ist
 			return cend();
 		}
 	};
+
+	// Fixed-capacity counting map for many writer threads. A key is published with a single CAS of
+	// its cell from empty_key to the key, so no thread ever waits on another; both the probe and
+	// the count are lock-free when std::atomic<K> and std::atomic<V> are. Each thread counts into
+	// one of several stripes, separate counter arrays, so hot keys do not bounce one cache line
+	// between cores; reads sum the stripes.
+	//
+	// Limits: the capacity is fixed and a cell, once claimed, keeps its key until clear(); drain()
+	// zeroes counts but frees nothing, so a key set that changes over time needs a periodic clear()
+	// or a fresh table per epoch, and a full table makes add() return false. Keys must fit a
+	// lock-free atomic, so label tuples have to be interned to an integer id first (an
+	// OpenHashTable behind a lock does, off the hot path). Memory is capacity * stripes counters.
+	template<class K, class V = size_t, class Hasher = std::hash<K>, class Keyeq = std::equal_to<K>>
+	class CountingHashTable
+	{
+	public:
+		using key_type    = K;
+		using mapped_type = V;
+		using value_type  = std::pair<K, V>;
+		using hasher      = Hasher;
+		using key_equal   = Keyeq;
+
+		static_assert(std::atomic<K>::is_always_lock_free, "CountingHashTable keys must fit a lock-free atomic");
+		static_assert(std::atomic<V>::is_always_lock_free, "CountingHashTable counters must be lock-free atomics");
+
+	private:
+		using counters = std::unique_ptr<std::atomic<mapped_type>[]>;
+
+	public:
+		// empty_key marks a free cell and can never be counted
+		explicit CountingHashTable(size_t capacity, size_t stripes = default_stripes(), key_type empty_key = key_type()) :
+			keys_(new std::atomic<key_type>[capacity]),
+			capacity_(capacity),
+			size_(0),
+			empty_key_(empty_key)
+		{
+			assert(capacity > 0 && "CountingHashTable capacity must be positive");
+			assert(stripes > 0 && "CountingHashTable needs at least one counter stripe");
+
+			for (size_t i = 0; i < capacity_; ++i)
+				keys_[i].store(empty_key_, std::memory_order_relaxed);
+
+			stripes_.reserve(stripes);
+			for (size_t i = 0; i < stripes; ++i)
+			{
+				stripes_.emplace_back(new std::atomic<mapped_type>[capacity_]);
+				for (size_t j = 0; j < capacity_; ++j)
+					stripes_.back()[j].store(mapped_type(), std::memory_order_relaxed);
+			}
+		}
+
+		CountingHashTable() : CountingHashTable(1024) {}
+
+		CountingHashTable(const CountingHashTable&) = delete;
+		CountingHashTable& operator=(const CountingHashTable&) = delete;
+
+	public:
+		// false if key is new and every cell already holds another key
+		bool add(const key_type& key, mapped_type delta = 1)
+		{
+			size_t index = find_or_insert(key);
+			if (index == capacity_) return false;
+
+			stripes_[stripe()][index].fetch_add(delta, std::memory_order_relaxed);
+			return true;
+		}
+
+		void increment(const key_type& key)
+		{
+			if (!add(key, 1))
+				throw std::length_error("CountingHashTable<K, V> is full");
+		}
+
+		mapped_type get(const key_type& key) const noexcept
+		{
+			size_t index = find(key);
+			return index != capacity_ ? count(index) : mapped_type();
+		}
+
+		bool contains(const key_type& key) const noexcept
+		{
+			return find(key) != capacity_;
+		}
+
+		template<class F>
+		void for_each(F f) const
+		{
+			for (size_t i = 0; i < capacity_; ++i)
+			{
+				key_type key = keys_[i].load(std::memory_order_acquire);
+				if (!is_empty(key))
+					f(key, count(i));
+			}
+		}
+
+		std::vector<value_type> snapshot() const
+		{
+			std::vector<value_type> result;
+			result.reserve(size());
+
+			for_each([&result](const key_type& key, mapped_type value)
+			{
+				result.emplace_back(key, value);
+			});
+
+			return result;
+		}
+
+		// Hands out the counts gathered so far and zeroes them while writers keep running
+		std::vector<value_type> drain()
+		{
+			std::vector<value_type> result;
+			result.reserve(size());
+
+			for (size_t i = 0; i < capacity_; ++i)
+			{
+				key_type key = keys_[i].load(std::memory_order_acquire);
+				if (is_empty(key)) continue;
+
+				mapped_type value = mapped_type();
+				for (const counters& counts : stripes_)
+					value += counts[i].exchange(mapped_type(), std::memory_order_relaxed);
+
+				if (value != mapped_type())
+					result.emplace_back(key, value);
+			}
+
+			return result;
+		}
+
+		// Frees every cell; no other thread may use the table meanwhile
+		void clear() noexcept
+		{
+			for (size_t i = 0; i < capacity_; ++i)
+			{
+				keys_[i].store(empty_key_, std::memory_order_relaxed);
+				for (const counters& counts : stripes_)
+					counts[i].store(mapped_type(), std::memory_order_relaxed);
+			}
+
+			size_.store(0, std::memory_order_release);
+		}
+
+		size_t size() const noexcept { return size_.load(std::memory_order_relaxed); }
+
+		size_t capacity() const noexcept { return capacity_; }
+
+		size_t stripe_count() const noexcept { return stripes_.size(); }
+
+		// One stripe per hardware thread, so no two cores share a counter line
+		static size_t default_stripes() noexcept
+		{
+			unsigned threads = std::thread::hardware_concurrency();
+			return threads != 0 ? threads : 1;
+		}
+
+		size_t hash(const key_type& key) const
+		{
+			static hasher hash_key;
+			return hash_key(key) % capacity_;
+		}
+
+	private:
+		// Index of key's cell, or capacity_ if it is absent
+		size_t find(const key_type& key) const noexcept
+		{
+			size_t pos = hash(key);
+
+			for (size_t i = 0; i < capacity_; ++i)
+			{
+				key_type current = keys_[pos].load(std::memory_order_acquire);
+
+				if (is_empty(current))
+					return capacity_;
+
+				if (key_equal_(current, key))
+					return pos;
+
+				pos = next(pos);
+			}
+
+			return capacity_;
+		}
+
+		size_t find_or_insert(const key_type& key)
+		{
+			assert(!is_empty(key) && "the empty key cannot be counted");
+
+			size_t pos = hash(key);
+
+			for (size_t i = 0; i < capacity_; ++i)
+			{
+				key_type current = keys_[pos].load(std::memory_order_acquire);
+
+				// A failed CAS leaves the winner's key in current, which may be this very key
+				if (is_empty(current) && keys_[pos].compare_exchange_strong(current, key, std::memory_order_acq_rel, std::memory_order_acquire))
+				{
+					size_.fetch_add(1, std::memory_order_relaxed);
+					return pos;
+				}
+
+				if (key_equal_(current, key))
+					return pos;
+
+				pos = next(pos);
+			}
+
+			return capacity_;
+		}
+
+		mapped_type count(size_t index) const noexcept
+		{
+			mapped_type value = mapped_type();
+			for (const counters& counts : stripes_)
+				value += counts[index].load(std::memory_order_relaxed);
+
+			return value;
+		}
+
+		// Threads take stripes round-robin in the order they first count
+		size_t stripe() const noexcept
+		{
+			static std::atomic<size_t> next_thread{ 0 };
+			thread_local size_t thread = next_thread.fetch_add(1, std::memory_order_relaxed);
+
+			return thread % stripes_.size();
+		}
+
+		bool is_empty(const key_type& key) const noexcept
+		{
+			return std::memcmp(&key, &empty_key_, sizeof(key_type)) == 0;
+		}
+
+		size_t next(size_t pos) const noexcept
+		{
+			return pos + 1 == capacity_ ? 0 : pos + 1;
+		}
+
+	private:
+		std::unique_ptr<std::atomic<key_type>[]> keys_;
+		std::vector<counters>                    stripes_;
+		size_t                                   capacity_;
+		std::atomic<size_t>                      size_;
+		key_type                                 empty_key_;
+		key_equal                                key_equal_;
+	};
 }
@@ -0,0 +1,67 @@
+#pragma once
+#include "my_tree.h"
+#include "my_tree_lib.h"
+
+#include <memory>
+
+namespace ist
+{
+	// Closed interval [lo, hi], ordered by lo and then by hi
+	template<class K>
+	struct Interval
+	{
+		K lo;
+		K hi;
+
+		[[nodiscard]] bool operator<(const Interval& other) const
+		{
+			return lo < other.lo || (!(other.lo < lo) && hi < other.hi);
+		}
+
+		[[nodiscard]] bool operator>(const Interval& other) const
+		{
+			return other < *this;
+		}
+	};
+
+	// A Tree keyed by Interval<K> that also keeps each subtree's largest hi, which lets it
+	// answer overlap and stab queries; insertion, erasure and iteration are the Tree's own
+	template<class K, class T, class Allocator = std::allocator<T>>
+	class IntervalMap : public Tree<Interval<K>, T, Allocator, TreeLib::MaxEndAugment<K>>
+	{
+	private:
+		using base = Tree<Interval<K>, T, Allocator, TreeLib::MaxEndAugment<K>>;
+
+	public:
+		using typename base::key_type;
+		using typename base::node;
+		using typename base::node_ptr;
+		using typename base::const_iterator;
+
+		using base::base;
+
+		// f(const node&) is called for every interval containing x, in ascending order
+		template<class F>
+		void stab(const K& x, F f) const
+		{
+			TreeLib::forEachOverlap(static_cast<const node*>(this->head_), x, x, f);
+		}
+
+		// f(const node&) is called for every interval overlapping [lo, hi], in ascending order
+		template<class F>
+		void overlap(const K& lo, const K& hi, F f) const
+		{
+			TreeLib::forEachOverlap(static_cast<const node*>(this->head_), lo, hi, f);
+		}
+
+		[[nodiscard]] const_iterator find_any_overlap(const K& lo, const K& hi) const noexcept
+		{
+			return const_iterator{ TreeLib::anyOverlap(this->head_, lo, hi), this };
+		}
+
+		[[nodiscard]] bool overlaps(const K& lo, const K& hi) const noexcept
+		{
+			return TreeLib::anyOverlap(this->head_, lo, hi) != nullptr;
+		}
+	};
+}
@@ -0,0 +1,408 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+namespace ist
+{
+	class IntrusiveListBase;
+
+	struct IntrusiveListHook
+	{
+		IntrusiveListHook()  noexcept : next(nullptr), prev(nullptr), owner(nullptr) {}
+
+		IntrusiveListHook(const IntrusiveListHook&) noexcept : IntrusiveListHook() {}
+		IntrusiveListHook& operator=(const IntrusiveListHook&) noexcept { return *this; }
+
+		~IntrusiveListHook()
+		{
+			assert(!is_linked() && "destroying an object that is still linked into an IntrusiveList");
+		}
+
+		bool is_linked() const noexcept
+		{
+			return owner != nullptr;
+		}
+
+		inline void unlink() noexcept;
+
+		IntrusiveListHook*  next;
+		IntrusiveListHook*  prev;
+		IntrusiveListBase*  owner;
+	};
+
+	class IntrusiveListBase
+	{
+	public:
+		using hook_ptr = IntrusiveListHook*;
+
+	protected:
+		IntrusiveListBase() noexcept : head_(nullptr), size_(0) {}
+
+		IntrusiveListBase(const IntrusiveListBase&) = delete;
+		IntrusiveListBase& operator=(const IntrusiveListBase&) = delete;
+
+		~IntrusiveListBase()
+		{
+			clear();
+		}
+
+	public:
+		void clear() noexcept
+		{
+			while (head_)
+				unlink_hook(head_);
+		}
+
+		size_t size() const noexcept
+		{
+			return size_;
+		}
+
+		bool empty() const noexcept
+		{
+			return size_ == 0;
+		}
+
+	protected:
+		friend struct IntrusiveListHook;
+
+		// Links hook in front of where; a null where appends at the back
+		void link_hook(hook_ptr where, hook_ptr hook) noexcept
+		{
+			assert(!hook->is_linked() && "object is already linked into an IntrusiveList");
+
+			hook->owner = this;
+			size_ += 1;
+
+			if (!head_)
+			{
+				head_ = hook;
+				hook->next = hook;
+				hook->prev = hook;
+				return;
+			}
+
+			hook_ptr before = where ? where : head_;
+
+			hook->next = before;
+			hook->prev = before->prev;
+			before->prev->next = hook;
+			before->prev = hook;
+
+			if (where == head_) head_ = hook;
+		}
+
+		hook_ptr unlink_hook(hook_ptr hook) noexcept
+		{
+			assert(hook->owner == this && "object is not linked into this IntrusiveList");
+
+			hook_ptr next    = hook->next;
+			bool     at_back = next == head_;
+
+			hook->prev->next = hook->next;
+			hook->next->prev = hook->prev;
+
+			if (hook == head_) head_ = next;
+
+			size_ -= 1;
+			if (size_ == 0) head_ = next = nullptr;
+
+			hook->next  = nullptr;
+			hook->prev  = nullptr;
+			hook->owner = nullptr;
+
+			return at_back ? nullptr : next;
+		}
+
+	protected:
+		hook_ptr head_;
+		size_t   size_;
+	};
+
+	inline void IntrusiveListHook::unlink() noexcept
+	{
+		if (owner)
+			owner->unlink_hook(this);
+	}
+
+	template<class T>
+	struct IntrusiveBaseHook
+	{
+		static IntrusiveListHook* to_hook(T& value) noexcept
+		{
+			return static_cast<IntrusiveListHook*>(&value);
+		}
+
+		static T* to_value(IntrusiveListHook* hook) noexcept
+		{
+			return static_cast<T*>(hook);
+		}
+	};
+
+	// Hook held in a member: IntrusiveMemberHook<T, &T::hook, offsetof(T, hook)>. A member pointer
+	// cannot be turned back into an offset, so the offset is passed too and T must be standard layout.
+	template<class T, IntrusiveListHook T::* Member, size_t Offset>
+	struct IntrusiveMemberHook
+	{
+		static_assert(std::is_standard_layout<T>::value, "IntrusiveMemberHook needs offsetof, which requires a standard-layout T");
+
+		static IntrusiveListHook* to_hook(T& value) noexcept
+		{
+			assert(reinterpret_cast<char*>(&(value.*Member)) - reinterpret_cast<char*>(&value) == static_cast<ptrdiff_t>(Offset)
+				&& "IntrusiveMemberHook offset does not match the member");
+
+			return &(value.*Member);
+		}
+
+		static T* to_value(IntrusiveListHook* hook) noexcept
+		{
+			return reinterpret_cast<T*>(reinterpret_cast<char*>(hook) - Offset);
+		}
+	};
+
+	template<class List>
+	class ConstIntrusiveListIterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using difference_type   = ptrdiff_t;
+
+		using value_type = typename List::value_type;
+		using hook_ptr   = typename List::hook_ptr;
+		using traits     = typename List::hook_traits;
+		using reference  = const value_type&;
+		using pointer    = const value_type*;
+
+		ConstIntrusiveListIterator() noexcept : ptr{}, list{} {}
+
+		explicit ConstIntrusiveListIterator(hook_ptr ptr, const List* list) noexcept
+			: ptr{ ptr }, list{ list } {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return *operator->();
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return traits::to_value(ptr);
+		}
+
+		ConstIntrusiveListIterator& operator++() noexcept
+		{
+			ptr = ptr->next == list->head_ ? nullptr : ptr->next;
+			return *this;
+		}
+
+		ConstIntrusiveListIterator operator++(int) noexcept
+		{
+			ConstIntrusiveListIterator tmp = *this;
+			++* this;
+			return tmp;
+		}
+
+		ConstIntrusiveListIterator& operator--() noexcept
+		{
+			ptr = ptr ? ptr->prev : list->head_->prev;
+			return *this;
+		}
+
+		ConstIntrusiveListIterator operator--(int) noexcept
+		{
+			ConstIntrusiveListIterator tmp = *this;
+			--* this;
+			return tmp;
+		}
+
+		[[nodiscard]] bool operator==(const ConstIntrusiveListIterator& other) const noexcept
+		{
+			return ptr == other.ptr;
+		}
+
+		[[nodiscard]] bool operator!=(const ConstIntrusiveListIterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+		hook_ptr    ptr;
+		const List* list;
+	};
+
+	template<class List>
+	class IntrusiveListIterator : public ConstIntrusiveListIterator<List>
+	{
+	public:
+		using my_base = ConstIntrusiveListIterator<List>;
+
+		using value_type = typename List::value_type;
+		using hook_ptr   = typename List::hook_ptr;
+		using reference  = value_type&;
+		using pointer    = value_type*;
+
+		IntrusiveListIterator() noexcept {}
+
+		explicit IntrusiveListIterator(hook_ptr ptr, const List* list) noexcept
+			: my_base(ptr, list) {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return const_cast<reference>(my_base::operator*());
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return const_cast<pointer>(my_base::operator->());
+		}
+
+		IntrusiveListIterator& operator++() noexcept
+		{
+			my_base::operator++();
+			return *this;
+		}
+
+		IntrusiveListIterator operator++(int) noexcept
+		{
+			IntrusiveListIterator iterator = *this;
+			my_base::operator++();
+			return iterator;
+		}
+
+		IntrusiveListIterator& operator--() noexcept
+		{
+			my_base::operator--();
+			return *this;
+		}
+
+		IntrusiveListIterator operator--(int) noexcept
+		{
+			IntrusiveListIterator iterator = *this;
+			my_base::operator--();
+			return iterator;
+		}
+	};
+
+	template<class T, class HookTraits = IntrusiveBaseHook<T>>
+	class IntrusiveList : public IntrusiveListBase
+	{
+	public:
+		using value_type  = T;
+		using hook_traits = HookTraits;
+
+		using reference  = value_type&;
+		using pointer    = value_type*;
+
+		using const_reference = const value_type&;
+		using const_pointer   = const value_type*;
+
+	public:
+		using const_iterator = ConstIntrusiveListIterator<IntrusiveList>;
+		using iterator       = IntrusiveListIterator<IntrusiveList>;
+
+		friend const_iterator;
+
+	public:
+		IntrusiveList() noexcept = default;
+
+	public:
+		iterator insert(const_iterator where, reference value) noexcept
+		{
+			hook_ptr hook = hook_traits::to_hook(value);
+			link_hook(where.ptr, hook);
+			return iterator{ hook, this };
+		}
+
+		void push_back(reference value) noexcept
+		{
+			link_hook(nullptr, hook_traits::to_hook(value));
+		}
+
+		void push_front(reference value) noexcept
+		{
+			link_hook(head_, hook_traits::to_hook(value));
+		}
+
+		void pop_back() noexcept
+		{
+			unlink_hook(head_->prev);
+		}
+
+		void pop_front() noexcept
+		{
+			unlink_hook(head_);
+		}
+
+		iterator erase(const_iterator where) noexcept
+		{
+			hook_ptr next = unlink_hook(where.ptr);
+			return iterator{ next, this };
+		}
+
+		void erase(reference value) noexcept
+		{
+			unlink_hook(hook_traits::to_hook(value));
+		}
+
+		bool contains(const_reference value) const noexcept
+		{
+			return hook_traits::to_hook(const_cast<reference>(value))->owner == this;
+		}
+
+		[[nodiscard]] iterator iterator_to(reference value) noexcept
+		{
+			return iterator{ hook_traits::to_hook(value), this };
+		}
+
+		reference front() noexcept
+		{
+			return *hook_traits::to_value(head_);
+		}
+
+		const_reference front() const noexcept
+		{
+			return *hook_traits::to_value(head_);
+		}
+
+		reference back() noexcept
+		{
+			return *hook_traits::to_value(head_->prev);
+		}
+
+		const_reference back() const noexcept
+		{
+			return *hook_traits::to_value(head_->prev);
+		}
+
+	public:
+		[[nodiscard]] iterator begin() noexcept
+		{
+			return iterator{ head_, this };
+		}
+
+		[[nodiscard]] const_iterator cbegin() const noexcept
+		{
+			return const_iterator{ head_, this };
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return iterator{ nullptr, this };
+		}
+
+		[[nodiscard]] const_iterator cend() const noexcept
+		{
+			return const_iterator{ nullptr, this };
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return cbegin();
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return cend();
+		}
+	};
+}
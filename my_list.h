@@ -1,4 +1,5 @@
 #pragma once
+#include <cassert>
 #include <memory>
 #include <functional>
 
@@ -128,11 +129,12 @@ namespace ist
 			: next(nullptr), prev(nullptr), value(std::forward<Args>(args)...) {}
 	};
 
-	template <class ValueType>
+	template <class ValueType, class Allocator = std::allocator<ValueType>>
 	class List
 	{
 	public:
-		using value_type = ValueType;
+		using value_type     = ValueType;
+		using allocator_type = Allocator;
 
 		using reference  = value_type&;
 		using pointer    = value_type*;
@@ -147,8 +149,62 @@ namespace ist
 		using const_iterator = ConstListIterator<List>;
 		using iterator		 = ListIterator<List>;
 
+	protected:
+		using Alloc		   = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+		using Alloc_traits = std::allocator_traits<Alloc>;
+
 	public:
-		List() : head_(nullptr), size_(0) {}
+		List() : head_(nullptr), size_(0), alloc_() {}
+
+		explicit List(const allocator_type& alloc) : head_(nullptr), size_(0), alloc_(alloc) {}
+
+		List(const List& other)
+			: head_(nullptr), size_(0), alloc_(Alloc_traits::select_on_container_copy_construction(other.alloc_))
+		{
+			if (!other.head_) return;
+
+			node_ptr ptr = other.head_;
+			do
+			{
+				emplace_back(ptr->value);
+				ptr = ptr->next;
+			} while (ptr != other.head_);
+		}
+
+		// The allocator is copied so the moved-from list keeps a usable one
+		List(List&& other) noexcept
+			: head_(other.head_), size_(other.size_), alloc_(other.alloc_)
+		{
+			other.head_ = nullptr;
+			other.size_ = 0;
+		}
+
+		// Copy-and-swap; the nodes change hands only if the allocator may be swapped too or the
+		// two compare equal, otherwise the elements move one by one into this list's allocator
+		List& operator=(List other)
+		{
+			if constexpr (Alloc_traits::propagate_on_container_swap::value)
+			{
+				std::swap(alloc_, other.alloc_);
+			}
+			else if (!(alloc_ == other.alloc_))
+			{
+				clear();
+				for (value_type& value : other)
+					emplace_back(std::move(value));
+
+				return *this;
+			}
+
+			std::swap(head_, other.head_);
+			std::swap(size_, other.size_);
+			return *this;
+		}
+
+		~List()
+		{
+			clear();
+		}
 
 	public:
 		iterator insert(const_iterator where, const value_type& val)
@@ -212,12 +268,155 @@ namespace ist
 
 		void remove(const value_type& element)
 		{
+			if (!head_) return;
+
 			for_each([this, &element](node_ptr node)
 			{
 				if (node->value == element)
 					erase_node(node);
 			});
 		}
+
+		void clear() noexcept
+		{
+			while (head_)
+				erase_node(head_);
+		}
+
+		size_t size() const noexcept
+		{
+			return size_;
+		}
+
+		bool empty() const noexcept
+		{
+			return size_ == 0;
+		}
+
+		allocator_type get_allocator() const noexcept
+		{
+			return allocator_type(alloc_);
+		}
+
+		// Splicing before begin() appends at the back, since begin() == end() here
+		void splice(const_iterator where, List& other)
+		{
+			assert(alloc_ == other.alloc_ && "splicing between lists with unequal allocators");
+
+			if (this == &other || !other.head_) return;
+
+			node_ptr first = other.head_;
+			node_ptr last  = other.head_->prev;
+			size_t   count = other.size_;
+
+			other.unlink_chain(first, last, count);
+			link_chain(where.ptr, first, last, count);
+		}
+
+		void splice(const_iterator where, List& other, const_iterator it)
+		{
+			assert(alloc_ == other.alloc_ && "splicing between lists with unequal allocators");
+
+			node_ptr first = it.ptr;
+			if (first == where.ptr) return;
+
+			other.unlink_chain(first, first, 1);
+			link_chain(where.ptr, first, first, 1);
+		}
+
+		// Since begin() == end(), a range from the head node to itself is the whole list;
+		// [it, it) anywhere else is empty. Within one list, where must not lie inside the range.
+		void splice(const_iterator where, List& other, const_iterator first, const_iterator last)
+		{
+			assert(alloc_ == other.alloc_ && "splicing between lists with unequal allocators");
+
+			node_ptr from = first.ptr;
+			node_ptr to   = last.ptr;
+			if (!from || (from == to && from != other.head_)) return;
+
+			bool same_list = this == &other;
+			if (same_list && (where.ptr == from || where.ptr == to)) return;
+
+			size_t   count = 0;
+			node_ptr tail  = from;
+			do
+			{
+				if (same_list && tail == where.ptr && tail != from)
+				{
+					assert(false && "splicing a range before one of its own elements");
+					return;
+				}
+
+				tail = tail->next;
+				count += 1;
+			} while (tail != to);
+
+			tail = tail->prev;
+
+			other.unlink_chain(from, tail, count);
+			link_chain(where.ptr, from, tail, count);
+		}
+
+		template<class Cmp = std::less<>>
+		void merge(List& other, Cmp cmp = Cmp())
+		{
+			assert(alloc_ == other.alloc_ && "merging lists with unequal allocators");
+
+			if (this == &other || !other.head_) return;
+
+			if (!head_)
+			{
+				std::swap(head_, other.head_);
+				std::swap(size_, other.size_);
+				return;
+			}
+
+			head_->prev->next = nullptr;
+			other.head_->prev->next = nullptr;
+
+			rebuild_links(merge_chains(head_, other.head_, cmp));
+			size_ += other.size_;
+
+			other.head_ = nullptr;
+			other.size_ = 0;
+		}
+
+		template<class Cmp = std::less<>>
+		void sort(Cmp cmp = Cmp())
+		{
+			if (size_ < 2) return;
+
+			// bins[i] holds a sorted chain of 2^i nodes, as in a binary counter
+			node_ptr bins[64] = {};
+			size_t   used = 0;
+
+			head_->prev->next = nullptr;
+			node_ptr ptr = head_;
+
+			while (ptr)
+			{
+				node_ptr carry = ptr;
+				ptr = ptr->next;
+				carry->next = nullptr;
+
+				size_t i = 0;
+				for (; i < used && bins[i]; ++i)
+				{
+					carry = merge_chains(bins[i], carry, cmp);
+					bins[i] = nullptr;
+				}
+
+				bins[i] = carry;
+				if (i == used) used += 1;
+			}
+
+			node_ptr result = nullptr;
+			for (size_t i = 0; i < used; ++i)
+				if (bins[i])
+					result = result ? merge_chains(bins[i], result, cmp) : bins[i];
+
+			rebuild_links(result);
+		}
 		
 		reference front()
 		{
@@ -240,10 +439,34 @@ namespace ist
 		}
 		
 	private:
+		template<class... Args>
+		node_ptr create_node(Args&&... args)
+		{
+			node_ptr ptr = Alloc_traits::allocate(alloc_, 1);
+
+			try
+			{
+				Alloc_traits::construct(alloc_, ptr, std::forward<Args>(args)...);
+			}
+			catch (...)
+			{
+				Alloc_traits::deallocate(alloc_, ptr, 1);
+				throw;
+			}
+
+			return ptr;
+		}
+
+		void destroy_node(node_ptr ptr) noexcept
+		{
+			Alloc_traits::destroy(alloc_, ptr);
+			Alloc_traits::deallocate(alloc_, ptr, 1);
+		}
+
 		template<class... Args>
 		node_ptr emplace_node(const node_ptr where, Args&&... args)
 		{
-			node_ptr new_node = new node(where->next, where, std::forward<Args>(args)...);
+			node_ptr new_node = create_node(where->next, where, std::forward<Args>(args)...);
 			where->next->prev = new_node;
 			where->next = new_node;
 
@@ -258,18 +481,97 @@ namespace ist
 
 			node_ptr next_node = ptr->next;
 			if (ptr == head_) head_ = next_node;
-			delete ptr;
+			destroy_node(ptr);
 
 			size_ -= 1;
+			if (size_ == 0) head_ = next_node = nullptr;
 			return next_node;
 		}
 
 		template<class... Args>
 		void create_head(Args&&... args)
 		{
-			head_ = new node(std::forward<Args>(args)...);
+			head_ = create_node(std::forward<Args>(args)...);
 			head_->next = head_;
 			head_->prev = head_;
+			size_ = 1;
+		}
+
+		void unlink_chain(node_ptr first, node_ptr last, size_t count) noexcept
+		{
+			size_ -= count;
+
+			if (size_ == 0)
+			{
+				head_ = nullptr;
+				return;
+			}
+
+			first->prev->next = last->next;
+			last->next->prev = first->prev;
+
+			if (first == head_) head_ = last->next;
+		}
+
+		void link_chain(node_ptr where, node_ptr first, node_ptr last, size_t count) noexcept
+		{
+			size_ += count;
+
+			if (!head_)
+			{
+				head_ = first;
+				first->prev = last;
+				last->next = first;
+				return;
+			}
+
+			if (!where) where = head_;
+
+			first->prev = where->prev;
+			last->next = where;
+			where->prev->next = first;
+			where->prev = last;
+		}
+
+		template<class Cmp>
+		static node_ptr merge_chains(node_ptr first, node_ptr second, Cmp& cmp)
+		{
+			node_ptr  result = nullptr;
+			node_ptr* tail   = &result;
+
+			while (first && second)
+			{
+				if (cmp(second->value, first->value))
+				{
+					*tail = second;
+					second = second->next;
+				}
+				else
+				{
+					*tail = first;
+					first = first->next;
+				}
+
+				tail = &(*tail)->next;
+			}
+
+			*tail = first ? first : second;
+			return result;
+		}
+
+		void rebuild_links(node_ptr first) noexcept
+		{
+			head_ = first;
+
+			node_ptr prev = first;
+			for (node_ptr ptr = first->next; ptr; ptr = ptr->next)
+			{
+				ptr->prev = prev;
+				prev = ptr;
+			}
+
+			prev->next = head_;
+			head_->prev = prev;
 		}
 		
 	public:
@@ -322,6 +624,7 @@ namespace ist
 	private:
 		node_ptr  head_;
 		size_t    size_;
+		Alloc     alloc_;
 	};
 
 }
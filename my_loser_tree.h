@@ -0,0 +1,176 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace ist
+{
+	// Adapts an iterator range to the source interface LoserTree merges from:
+	// empty(), front() and pop(). Generators only need to provide the same three members.
+	template<class Iter>
+	class RangeSource
+	{
+	public:
+		RangeSource(Iter start, Iter end)
+			: cur_(start), end_(end) {}
+
+		[[nodiscard]] bool empty() const
+		{
+			return cur_ == end_;
+		}
+
+		[[nodiscard]] decltype(auto) front() const
+		{
+			return *cur_;
+		}
+
+		void pop()
+		{
+			++cur_;
+		}
+
+		[[nodiscard]] Iter position() const
+		{
+			return cur_;
+		}
+
+	private:
+		Iter cur_;
+		Iter end_;
+	};
+
+	// Tournament tree over k sorted sources. Every inner node keeps the loser of the match played
+	// there, so replacing the winner replays only its path to the root: log2(k) comparisons per
+	// element. Ties go to the lower source index, which keeps a less_equal cmp stable.
+	template<class Sources, class Cmp = std::less_equal<>>
+	class LoserTree
+	{
+	public:
+		explicit LoserTree(Sources& sources, Cmp cmp = Cmp())
+			: sources_(sources), cmp_(cmp), k_(static_cast<size_t>(std::size(sources))), tree_(k_)
+		{
+			if (k_ != 0) tree_[0] = play(1);
+		}
+
+		LoserTree(const LoserTree&) = delete;
+		LoserTree& operator=(const LoserTree&) = delete;
+
+		[[nodiscard]] bool empty() const
+		{
+			return k_ == 0 || sources_[tree_[0]].empty();
+		}
+
+		// Index of the source that holds the next element
+		[[nodiscard]] size_t top() const noexcept
+		{
+			return tree_[0];
+		}
+
+		[[nodiscard]] decltype(auto) front() const
+		{
+			assert(!empty() && "front on an exhausted merge");
+			return sources_[tree_[0]].front();
+		}
+
+		void pop()
+		{
+			assert(!empty() && "pop on an exhausted merge");
+
+			size_t winner = tree_[0];
+			sources_[winner].pop();
+
+			for (size_t node = (winner + k_) / 2; node != 0; node /= 2)
+			{
+				if (beats(tree_[node], winner))
+					std::swap(tree_[node], winner);
+			}
+
+			tree_[0] = winner;
+		}
+
+	private:
+		// Whether source a's head goes out before source b's; exhausted sources lose every match
+		bool beats(size_t a, size_t b) const
+		{
+			if (sources_[a].empty()) return false;
+			if (sources_[b].empty()) return true;
+
+			const auto& x = sources_[a].front();
+			const auto& y = sources_[b].front();
+
+			if (!cmp_(x, y)) return false;
+
+			return a < b || !cmp_(y, x);
+		}
+
+		// Leaves sit at nodes k..2k-1; returns the winner below node and stores the losers
+		size_t play(size_t node)
+		{
+			if (node >= k_) return node - k_;
+
+			size_t left  = play(2 * node);
+			size_t right = play(2 * node + 1);
+
+			if (beats(left, right))
+			{
+				tree_[node] = right;
+				return left;
+			}
+
+			tree_[node] = left;
+			return right;
+		}
+
+	private:
+		Sources&            sources_;
+		mutable Cmp         cmp_;
+		size_t              k_;
+		std::vector<size_t> tree_;
+	};
+
+	// Drains every source through a loser tree into out in one pass
+	template<class Sources, class OutIter, class Cmp = std::less_equal<>>
+	OutIter merge_sources(Sources& sources, OutIter out, Cmp cmp = std::less_equal<>())
+	{
+		LoserTree<Sources, Cmp> tree(sources, cmp);
+
+		for (; !tree.empty(); tree.pop())
+			*out++ = tree.front();
+
+		return out;
+	}
+
+	// Merges the sorted ranges described by [first, last), each a pair of iterators, into out
+	template<class RangeIter, class OutIter, class Cmp = std::less_equal<>>
+	OutIter multiway_merge(RangeIter first, RangeIter last, OutIter out, Cmp cmp = std::less_equal<>())
+	{
+		using iterator = decltype(first->first);
+
+		std::vector<RangeSource<iterator>> sources;
+		for (; first != last; ++first)
+			sources.emplace_back(first->first, first->second);
+
+		return merge_sources(sources, out, cmp);
+	}
+
+	// multiway_merge that moves the elements out of the input ranges
+	template<class RangeIter, class OutIter, class Cmp = std::less_equal<>>
+	OutIter multiway_move_merge(RangeIter first, RangeIter last, OutIter out, Cmp cmp = std::less_equal<>())
+	{
+		using iterator = decltype(first->first);
+
+		std::vector<RangeSource<iterator>> sources;
+		for (; first != last; ++first)
+			sources.emplace_back(first->first, first->second);
+
+		LoserTree<decltype(sources), Cmp> tree(sources, cmp);
+
+		for (; !tree.empty(); tree.pop())
+			*out++ = std::move(*sources[tree.top()].position());
+
+		return out;
+	}
+}
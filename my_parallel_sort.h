@@ -0,0 +1,118 @@
+#pragma once
+#include "my_sort.h"
+#include "my_thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace ist
+{
+	// Ranges at or below this many elements are sorted or merged by the calling task
+	static constexpr ptrdiff_t parallel_sort_grain = 1 << 14;
+
+	template<class InIter, class OutIter, class Cmp>
+	OutIter move_merge(InIter first_start, InIter first_end, InIter second_start, InIter second_end, OutIter out, Cmp cmp)
+	{
+		while (first_start != first_end && second_start != second_end)
+		{
+			if (cmp(*first_start, *second_start))
+				*out++ = std::move(*first_start++);
+			else
+				*out++ = std::move(*second_start++);
+		}
+
+		out = std::move(first_start, first_end, out);
+		return std::move(second_start, second_end, out);
+	}
+
+	// Splits the output at the middle of the longer run and the matching co-rank in the other
+	// run, so both halves of the merge proceed independently and equal keys stay stable
+	template<class InIter, class OutIter, class Cmp>
+	void parallel_merge(WorkStealingPool& pool, InIter first_start, InIter first_end, InIter second_start, InIter second_end,
+		OutIter out, Cmp cmp, ptrdiff_t grain)
+	{
+		ptrdiff_t first_size  = first_end - first_start;
+		ptrdiff_t second_size = second_end - second_start;
+
+		if (first_size + second_size <= grain)
+		{
+			move_merge(first_start, first_end, second_start, second_end, out, cmp);
+			return;
+		}
+
+		ptrdiff_t i;
+		ptrdiff_t j;
+
+		if (first_size >= second_size)
+		{
+			i = first_size / 2;
+			const auto& pivot = first_start[i];
+			j = std::partition_point(second_start, second_end, [&](const auto& value) { return !cmp(pivot, value); }) - second_start;
+		}
+		else
+		{
+			j = second_size / 2;
+			const auto& pivot = second_start[j];
+			i = std::partition_point(first_start, first_end, [&](const auto& value) { return cmp(value, pivot); }) - first_start;
+		}
+
+		TaskGroup group(pool);
+		group.run([&] { parallel_merge(pool, first_start, first_start + i, second_start, second_start + j, out, cmp, grain); });
+		parallel_merge(pool, first_start + i, first_end, second_start + j, second_end, out + (i + j), cmp, grain);
+		group.wait();
+	}
+
+	// Sorts [data, data + n) and leaves the result in data or, if into_buffer, in buffer
+	template<class Iter, class BufferIter, class Cmp>
+	void parallel_merge_sort_step(WorkStealingPool& pool, Iter data, BufferIter buffer, ptrdiff_t n, bool into_buffer, Cmp cmp, ptrdiff_t grain)
+	{
+		if (n <= grain)
+		{
+			merge_sort_buffered(data, data + n, buffer, cmp);
+			if (into_buffer) std::move(data, data + n, buffer);
+			return;
+		}
+
+		ptrdiff_t half = n / 2;
+
+		TaskGroup group(pool);
+		group.run([&] { parallel_merge_sort_step(pool, data, buffer, half, !into_buffer, cmp, grain); });
+		parallel_merge_sort_step(pool, data + half, buffer + half, n - half, !into_buffer, cmp, grain);
+		group.wait();
+
+		if (into_buffer)
+			parallel_merge(pool, data, data + half, data + half, data + n, buffer, cmp, grain);
+		else
+			parallel_merge(pool, buffer, buffer + half, buffer + half, buffer + n, data, cmp, grain);
+	}
+
+	template<class Iter, class Cmp = std::less_equal<>>
+	void parallel_merge_sort(WorkStealingPool& pool, Iter start, Iter end, Cmp cmp = std::less_equal<>(), ptrdiff_t grain = parallel_sort_grain)
+	{
+		assert(start <= end && "transposed iterator range");
+
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		ptrdiff_t n = end - start;
+		grain = std::max(grain, insertion_sort_threshold);
+
+		if (n <= grain)
+		{
+			merge_sort(start, end, cmp);
+			return;
+		}
+
+		std::vector<value_type> buffer(static_cast<size_t>(n));
+		parallel_merge_sort_step(pool, start, buffer.begin(), n, false, cmp, grain);
+	}
+
+	template<class Iter, class Cmp = std::less_equal<>>
+	void parallel_merge_sort(Iter start, Iter end, Cmp cmp = std::less_equal<>(), ptrdiff_t grain = parallel_sort_grain)
+	{
+		parallel_merge_sort(WorkStealingPool::default_pool(), start, end, cmp, grain);
+	}
+}
@@ -0,0 +1,465 @@
+#pragma once
+#include "my_tree_lib.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace ist
+{
+	template<class K, class T>
+	struct PersistentNode
+	{
+		PersistentNode(const K& key, const T& value, const PersistentNode* left, const PersistentNode* right)
+			: refs(1), left(left), right(right), key(key), height(1), value(value) {}
+
+		mutable std::atomic<size_t> refs;
+
+		const PersistentNode* left;
+		const PersistentNode* right;
+
+		K            key;
+		std::uint8_t height;
+		T            value;
+	};
+
+	template<class Tree>
+	class PersistentTreeIterator
+	{
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using difference_type   = ptrdiff_t;
+
+		using value_type = typename Tree::node;
+		using node_ptr   = const value_type*;
+		using reference  = const value_type&;
+		using pointer    = const value_type*;
+
+		PersistentTreeIterator() = default;
+
+		explicit PersistentTreeIterator(node_ptr root)
+		{
+			push_left(root);
+		}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return *stack_.back();
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return stack_.back();
+		}
+
+		PersistentTreeIterator& operator++()
+		{
+			node_ptr ptr = stack_.back();
+			stack_.pop_back();
+			push_left(ptr->right);
+			return *this;
+		}
+
+		PersistentTreeIterator operator++(int)
+		{
+			PersistentTreeIterator tmp = *this;
+			++* this;
+			return tmp;
+		}
+
+		[[nodiscard]] bool operator==(const PersistentTreeIterator& other) const noexcept
+		{
+			return stack_.empty() ? other.stack_.empty() : !other.stack_.empty() && stack_.back() == other.stack_.back();
+		}
+
+		[[nodiscard]] bool operator!=(const PersistentTreeIterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+	private:
+		friend Tree;
+
+		void push_left(node_ptr ptr)
+		{
+			for (; ptr; ptr = ptr->left)
+				stack_.push_back(ptr);
+		}
+
+		// The stack holds the unvisited ancestors, so iteration needs no parent pointers
+		std::vector<node_ptr> stack_;
+	};
+
+	template<class K, class T>
+	class PersistentTree
+	{
+	public:
+		using key_type        = K;
+		using value_type      = T;
+
+		using const_reference = const value_type&;
+		using const_pointer   = const value_type*;
+
+		using node     = PersistentNode<K, T>;
+		using node_ptr = const node*;
+
+	public:
+		class Snapshot
+		{
+		public:
+			using const_iterator = PersistentTreeIterator<Snapshot>;
+			using iterator       = const_iterator;
+			using node           = PersistentTree::node;
+
+			Snapshot() noexcept : root_(nullptr), size_(0) {}
+
+			Snapshot(const Snapshot& other) noexcept
+				: root_(retain(other.root_)), size_(other.size_) {}
+
+			Snapshot(Snapshot&& other) noexcept
+				: root_(other.root_), size_(other.size_)
+			{
+				other.root_ = nullptr;
+				other.size_ = 0;
+			}
+
+			Snapshot& operator=(Snapshot other) noexcept
+			{
+				std::swap(root_, other.root_);
+				std::swap(size_, other.size_);
+				return *this;
+			}
+
+			~Snapshot()
+			{
+				release(root_);
+			}
+
+			size_t size() const noexcept { return size_; }
+
+			bool empty() const noexcept { return size_ == 0; }
+
+			[[nodiscard]] const_pointer find(const key_type& key) const noexcept
+			{
+				node_ptr p = PersistentTree::find(root_, key);
+				return p ? &p->value : nullptr;
+			}
+
+			[[nodiscard]] bool contains(const key_type& key) const noexcept
+			{
+				return PersistentTree::find(root_, key) != nullptr;
+			}
+
+			[[nodiscard]] const_iterator lower_bound(const key_type& key) const
+			{
+				const_iterator it;
+
+				for (node_ptr p = root_; p; )
+				{
+					if (p->key < key)
+					{
+						p = p->right;
+					}
+					else
+					{
+						it.stack_.push_back(p);
+						p = p->left;
+					}
+				}
+
+				return it;
+			}
+
+			[[nodiscard]] const_iterator begin() const
+			{
+				return const_iterator{ root_ };
+			}
+
+			[[nodiscard]] const_iterator end() const noexcept
+			{
+				return const_iterator{};
+			}
+
+		private:
+			friend PersistentTree;
+
+			Snapshot(node_ptr root, size_t size) noexcept
+				: root_(root), size_(size) {}
+
+			node_ptr root_;
+			size_t   size_;
+		};
+
+	public:
+		PersistentTree() noexcept : root_(nullptr), size_(0) {}
+
+		PersistentTree(const PersistentTree&) = delete;
+		PersistentTree& operator=(const PersistentTree&) = delete;
+
+		~PersistentTree()
+		{
+			release(root_);
+		}
+
+	public:
+		// Writers are serialized; readers only contend on the O(1) root swap
+		template<class... Args>
+		void emplace(const key_type& key, Args&&... args)
+		{
+			T value(std::forward<Args>(args)...);
+
+			std::lock_guard<std::mutex> lock(writer_);
+			publish(insert(root_, key, value).release(), size_ + 1);
+		}
+
+		void insert(const key_type& key, const value_type& value)
+		{
+			emplace(key, value);
+		}
+
+		bool erase(const key_type& key)
+		{
+			std::lock_guard<std::mutex> lock(writer_);
+
+			if (!find(root_, key)) return false;
+
+			publish(remove(root_, key).release(), size_ - 1);
+			return true;
+		}
+
+		[[nodiscard]] Snapshot snapshot() const noexcept
+		{
+			lock_root();
+			Snapshot result{ retain(root_), size_ };
+			unlock_root();
+
+			return result;
+		}
+
+		size_t size() const noexcept
+		{
+			std::lock_guard<std::mutex> lock(writer_);
+			return size_;
+		}
+
+	private:
+		static node_ptr retain(node_ptr p) noexcept
+		{
+			if (p) p->refs.fetch_add(1, std::memory_order_relaxed);
+			return p;
+		}
+
+		static void release(node_ptr p) noexcept
+		{
+			if (!p || p->refs.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+
+			release(p->left);
+			release(p->right);
+			delete p;
+		}
+
+		// Drops one reference when an exception unwinds a half-built path
+		struct unref
+		{
+			void operator()(node_ptr p) const noexcept
+			{
+				release(p);
+			}
+		};
+
+		// A node of the new path, not yet shared, that may be modified in place
+		using fresh = std::unique_ptr<node, unref>;
+
+		// One reference to a subtree that may be shared with other versions
+		using owned = std::unique_ptr<const node, unref>;
+
+		// A fresh copy of p; the children are retained only once nothing can throw any more
+		static fresh copy(node_ptr p)
+		{
+			fresh q(new node(p->key, p->value, nullptr, nullptr));
+			q->left = retain(p->left);
+			q->right = retain(p->right);
+			q->height = p->height;
+
+			return q;
+		}
+
+		// Rotations copy the child that moves up; p still owns all its children if that throws
+		static fresh rotateRight(fresh p)
+		{
+			fresh q = copy(p->left);
+			release(p->left);
+
+			p->left = q->right;
+			TreeLib::updateHeight(p.get());
+			q->right = p.release();
+			TreeLib::updateHeight(q.get());
+
+			return q;
+		}
+
+		static fresh rotateLeft(fresh q)
+		{
+			fresh p = copy(q->right);
+			release(q->right);
+
+			q->right = p->left;
+			TreeLib::updateHeight(q.get());
+			p->left = q.release();
+			TreeLib::updateHeight(p.get());
+
+			return p;
+		}
+
+		static fresh balance(fresh p)
+		{
+			TreeLib::updateHeight(p.get());
+
+			if (TreeLib::bFactor(p.get()) == 2)
+			{
+				if (TreeLib::bFactor(p->right) < 0)
+				{
+					fresh r = rotateRight(copy(p->right));
+					release(p->right);
+					p->right = r.release();
+				}
+
+				return rotateLeft(std::move(p));
+			}
+
+			if (TreeLib::bFactor(p.get()) == -2)
+			{
+				if (TreeLib::bFactor(p->left) > 0)
+				{
+					fresh l = rotateLeft(copy(p->left));
+					release(p->left);
+					p->left = l.release();
+				}
+
+				return rotateRight(std::move(p));
+			}
+
+			return p;
+		}
+
+		static node_ptr find(node_ptr p, const key_type& key) noexcept
+		{
+			while (p)
+			{
+				if (key < p->key)
+					p = p->left;
+				else if (p->key < key)
+					p = p->right;
+				else
+					return p;
+			}
+
+			return nullptr;
+		}
+
+		// Each level builds the new subtree below it before swapping it in, so a throw
+		// anywhere releases exactly the nodes and references the new path took
+		static fresh insert(node_ptr p, const key_type& key, const value_type& value)
+		{
+			if (!p)
+				return fresh(new node(key, value, nullptr, nullptr));
+
+			fresh q = copy(p);
+
+			if (key < p->key)
+			{
+				fresh child = insert(p->left, key, value);
+				release(q->left);
+				q->left = child.release();
+			}
+			else
+			{
+				fresh child = insert(p->right, key, value);
+				release(q->right);
+				q->right = child.release();
+			}
+
+			return balance(std::move(q));
+		}
+
+		static owned removeMin(node_ptr p)
+		{
+			if (!p->left)
+				return owned(retain(p->right));
+
+			fresh q = copy(p);
+			owned child = removeMin(p->left);
+			release(q->left);
+			q->left = child.release();
+
+			return balance(std::move(q));
+		}
+
+		static owned remove(node_ptr p, const key_type& key)
+		{
+			if (key < p->key || p->key < key)
+			{
+				fresh q = copy(p);
+				owned child = remove(key < p->key ? p->left : p->right, key);
+
+				if (key < p->key)
+				{
+					release(q->left);
+					q->left = child.release();
+				}
+				else
+				{
+					release(q->right);
+					q->right = child.release();
+				}
+
+				return balance(std::move(q));
+			}
+
+			if (!p->right)
+				return owned(retain(p->left));
+
+			node_ptr min = p->right;
+			while (min->left) min = min->left;
+
+			fresh q(new node(min->key, min->value, nullptr, nullptr));
+			owned right = removeMin(p->right);
+			q->left = retain(p->left);
+			q->right = right.release();
+
+			return balance(std::move(q));
+		}
+
+		void publish(node_ptr root, size_t size) noexcept
+		{
+			lock_root();
+			node_ptr old = root_;
+			root_ = root;
+			size_ = size;
+			unlock_root();
+
+			release(old);
+		}
+
+		void lock_root() const noexcept
+		{
+			while (root_lock_.test_and_set(std::memory_order_acquire)) {}
+		}
+
+		void unlock_root() const noexcept
+		{
+			root_lock_.clear(std::memory_order_release);
+		}
+
+	private:
+		node_ptr                 root_;
+		size_t                   size_;
+		mutable std::atomic_flag root_lock_ = ATOMIC_FLAG_INIT;
+		mutable std::mutex       writer_;
+	};
+}
@@ -0,0 +1,390 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+namespace ist
+{
+	template<size_t BlockSize, size_t BlockAlign = alignof(std::max_align_t)>
+	class FixedPool
+	{
+	private:
+		struct free_block
+		{
+			free_block* next;
+		};
+
+	public:
+		static constexpr size_t block_align = BlockAlign > alignof(free_block) ? BlockAlign : alignof(free_block);
+		static constexpr size_t block_size  = ((BlockSize > sizeof(free_block) ? BlockSize : sizeof(free_block)) + block_align - 1) / block_align * block_align;
+		static constexpr size_t slab_bytes  = 16 * 1024;
+		static constexpr size_t default_blocks_per_slab = slab_bytes / block_size > 16 ? slab_bytes / block_size : 16;
+
+	public:
+		explicit FixedPool(size_t blocks_per_slab = default_blocks_per_slab)
+			: free_list_(nullptr), blocks_per_slab_(blocks_per_slab)
+		{
+			assert(blocks_per_slab > 0 && "FixedPool slab must hold at least one block");
+		}
+
+		FixedPool(const FixedPool&) = delete;
+		FixedPool& operator=(const FixedPool&) = delete;
+
+		~FixedPool()
+		{
+			release();
+		}
+
+	public:
+		void* allocate()
+		{
+			if (!free_list_)
+				grow();
+
+			free_block* block = free_list_;
+			free_list_ = block->next;
+			return block;
+		}
+
+		void deallocate(void* ptr) noexcept
+		{
+			free_block* block = static_cast<free_block*>(ptr);
+			block->next = free_list_;
+			free_list_ = block;
+		}
+
+		void release() noexcept
+		{
+			for (void* slab : slabs_)
+				::operator delete(slab, std::align_val_t{ block_align });
+
+			slabs_.clear();
+			free_list_ = nullptr;
+		}
+
+		size_t slab_count() const noexcept { return slabs_.size(); }
+
+		size_t blocks_per_slab() const noexcept { return blocks_per_slab_; }
+
+	private:
+		void grow()
+		{
+			slabs_.reserve(slabs_.size() + 1);
+
+			char* slab = static_cast<char*>(::operator new(block_size * blocks_per_slab_, std::align_val_t{ block_align }));
+			slabs_.push_back(slab);
+
+			// Thread the blocks in address order so consecutive allocations stay adjacent
+			for (size_t i = blocks_per_slab_; i > 0; --i)
+				deallocate(slab + (i - 1) * block_size);
+		}
+
+	private:
+		free_block*        free_list_;
+		size_t             blocks_per_slab_;
+		std::vector<void*> slabs_;
+	};
+
+	template<size_t BlockSize, size_t BlockAlign = alignof(std::max_align_t), size_t CacheSize = 64>
+	class SharedPool
+	{
+	private:
+		struct depot
+		{
+			explicit depot(size_t blocks_per_slab) : pool(blocks_per_slab) {}
+
+			std::mutex                       mutex;
+			FixedPool<BlockSize, BlockAlign> pool;
+		};
+
+		struct thread_cache
+		{
+			size_t               owner = 0;
+			std::weak_ptr<depot> home;
+			size_t               count = 0;
+			void*                blocks[CacheSize];
+
+			~thread_cache()
+			{
+				flush();
+			}
+
+			// Hands the cached blocks back to the pool they came from; if that pool is gone,
+			// its slabs went with it and the blocks are simply forgotten
+			void flush() noexcept
+			{
+				if (std::shared_ptr<depot> pool = home.lock())
+				{
+					std::lock_guard<std::mutex> lock(pool->mutex);
+					while (count > 0)
+						pool->pool.deallocate(blocks[--count]);
+				}
+
+				count = 0;
+			}
+		};
+
+	public:
+		explicit SharedPool(size_t blocks_per_slab = FixedPool<BlockSize, BlockAlign>::default_blocks_per_slab)
+			: depot_(std::make_shared<depot>(blocks_per_slab)), id_(next_id()) {}
+
+		SharedPool(const SharedPool&) = delete;
+		SharedPool& operator=(const SharedPool&) = delete;
+
+	public:
+		void* allocate()
+		{
+			thread_cache& cache = local_cache();
+
+			if (cache.count == 0)
+			{
+				std::lock_guard<std::mutex> lock(depot_->mutex);
+				while (cache.count < CacheSize / 2)
+					cache.blocks[cache.count++] = depot_->pool.allocate();
+			}
+
+			return cache.blocks[--cache.count];
+		}
+
+		void deallocate(void* ptr) noexcept
+		{
+			thread_cache& cache = local_cache();
+
+			if (cache.count == CacheSize)
+			{
+				std::lock_guard<std::mutex> lock(depot_->mutex);
+				while (cache.count > CacheSize / 2)
+					depot_->pool.deallocate(cache.blocks[--cache.count]);
+			}
+
+			cache.blocks[cache.count++] = ptr;
+		}
+
+	private:
+		// A thread caches blocks for one pool at a time; switching to another pool
+		// returns the cached blocks to the previous one first
+		thread_cache& local_cache() noexcept
+		{
+			static thread_local thread_cache cache;
+
+			if (cache.owner != id_)
+			{
+				cache.flush();
+				cache.owner = id_;
+				cache.home = depot_;
+			}
+
+			return cache;
+		}
+
+		static size_t next_id() noexcept
+		{
+			static std::atomic<size_t> counter{ 0 };
+			return ++counter;
+		}
+
+	private:
+		std::shared_ptr<depot> depot_;
+		size_t                 id_;
+	};
+
+	// The pools behind one family of rebound allocators, one per block size and alignment. An
+	// allocator and every rebound copy of it share the resource, so PoolAllocator<T> and the
+	// PoolAllocator<node> a container rebinds it to compare equal and draw from the same place.
+	template<bool ThreadCache>
+	class PoolResource
+	{
+	public:
+		template<size_t BlockSize, size_t BlockAlign>
+		using pool_type = std::conditional_t<ThreadCache, SharedPool<BlockSize, BlockAlign>, FixedPool<BlockSize, BlockAlign>>;
+
+	public:
+		PoolResource() = default;
+
+		PoolResource(const PoolResource&) = delete;
+		PoolResource& operator=(const PoolResource&) = delete;
+
+		// Looked up when an allocator is built or rebound, not on every allocation
+		template<size_t BlockSize, size_t BlockAlign>
+		pool_type<BlockSize, BlockAlign>& pool()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+
+			for (const entry& e : pools_)
+			{
+				if (e.block_size == BlockSize && e.block_align == BlockAlign)
+					return *static_cast<pool_type<BlockSize, BlockAlign>*>(e.pool.get());
+			}
+
+			auto pool = std::make_shared<pool_type<BlockSize, BlockAlign>>();
+			pools_.push_back({ BlockSize, BlockAlign, pool });
+
+			return *pool;
+		}
+
+	private:
+		struct entry
+		{
+			size_t                block_size;
+			size_t                block_align;
+			std::shared_ptr<void> pool;
+		};
+
+		std::mutex         mutex_;
+		std::vector<entry> pools_;
+	};
+
+	template<class T, bool ThreadCache = false>
+	class PoolAllocator
+	{
+	public:
+		using value_type    = T;
+		using resource_type = PoolResource<ThreadCache>;
+		using pool_type     = typename resource_type::template pool_type<sizeof(T), alignof(T)>;
+
+		// Only the thread-cached pools lock around the shared free list
+		using is_thread_safe = std::bool_constant<ThreadCache>;
+
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap            = std::true_type;
+
+		template<class U>
+		struct rebind
+		{
+			using other = PoolAllocator<U, ThreadCache>;
+		};
+
+	public:
+		PoolAllocator() : PoolAllocator(std::make_shared<resource_type>()) {}
+
+		explicit PoolAllocator(std::shared_ptr<resource_type> resource)
+			: resource_(std::move(resource)), pool_(&resource_->template pool<sizeof(T), alignof(T)>()) {}
+
+		template<class U>
+		PoolAllocator(const PoolAllocator<U, ThreadCache>& other) : PoolAllocator(other.resource_) {}
+
+	public:
+		[[nodiscard]] T* allocate(size_t n)
+		{
+			if (n == 1)
+				return static_cast<T*>(pool_->allocate());
+
+			return std::allocator<T>().allocate(n);
+		}
+
+		void deallocate(T* ptr, size_t n) noexcept
+		{
+			if (n == 1)
+				pool_->deallocate(ptr);
+			else
+				std::allocator<T>().deallocate(ptr, n);
+		}
+
+		template<class U>
+		[[nodiscard]] bool operator==(const PoolAllocator<U, ThreadCache>& other) const noexcept
+		{
+			return resource_ == other.resource_;
+		}
+
+		template<class U>
+		[[nodiscard]] bool operator!=(const PoolAllocator<U, ThreadCache>& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+	private:
+		template<class U, bool>
+		friend class PoolAllocator;
+
+		std::shared_ptr<resource_type> resource_;
+		pool_type*                     pool_;
+	};
+
+	template<class T>
+	class ArenaAllocator
+	{
+	public:
+		using value_type    = T;
+		using resource_type = PoolResource<false>;
+		using pool_type     = typename resource_type::template pool_type<sizeof(T), alignof(T)>;
+
+		using propagate_on_container_copy_assignment = std::false_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap            = std::true_type;
+
+		template<class U>
+		struct rebind
+		{
+			using other = ArenaAllocator<U>;
+		};
+
+	public:
+		ArenaAllocator() : ArenaAllocator(std::make_shared<resource_type>()) {}
+
+		explicit ArenaAllocator(std::shared_ptr<resource_type> resource)
+			: resource_(std::move(resource)), pool_(&resource_->template pool<sizeof(T), alignof(T)>()) {}
+
+		template<class U>
+		ArenaAllocator(const ArenaAllocator<U>& other) : ArenaAllocator(other.resource_) {}
+
+		// A copied container starts its own arena, so release() never frees another container's nodes
+		ArenaAllocator select_on_container_copy_construction() const
+		{
+			return ArenaAllocator();
+		}
+
+	public:
+		[[nodiscard]] T* allocate(size_t n)
+		{
+			if (n == 1)
+				return static_cast<T*>(pool_->allocate());
+
+			return std::allocator<T>().allocate(n);
+		}
+
+		void deallocate(T* ptr, size_t n) noexcept
+		{
+			if (n == 1)
+				pool_->deallocate(ptr);
+			else
+				std::allocator<T>().deallocate(ptr, n);
+		}
+
+		// Frees every T block of the arena at once, live or not
+		void release() noexcept
+		{
+			pool_->release();
+		}
+
+		// Allocators, rebound ones included, sharing this arena
+		[[nodiscard]] long use_count() const noexcept
+		{
+			return resource_.use_count();
+		}
+
+		template<class U>
+		[[nodiscard]] bool operator==(const ArenaAllocator<U>& other) const noexcept
+		{
+			return resource_ == other.resource_;
+		}
+
+		template<class U>
+		[[nodiscard]] bool operator!=(const ArenaAllocator<U>& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+	private:
+		template<class U>
+		friend class ArenaAllocator;
+
+		std::shared_ptr<resource_type> resource_;
+		pool_type*                     pool_;
+	};
+}
@@ -0,0 +1,417 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__SSE4_1__)
+#include <immintrin.h>
+#endif
+
+namespace ist
+{
+	// Register-level sort kernels: int32 with AVX2 or SSE4.1, int64 with AVX2. A min/max network
+	// does not keep equal elements in order, so only integers, whose equal values cannot be told
+	// apart, are handled; float and double would lose the stability merge_sort promises for
+	// signed zeros and NaNs.
+	template<class T>
+	struct SimdSortTraits
+	{
+		static constexpr bool enabled = false;
+	};
+
+#if defined(__AVX2__)
+	// Lane shuffles shared by every 8 x 32-bit element type
+	struct Avx2Lanes32
+	{
+		static constexpr size_t lanes = 8;
+
+		static __m256i reverse(__m256i v) noexcept
+		{
+			return _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+		}
+
+		// Level i pairs lanes that are lanes >> (i + 1) apart; take_upper keeps hi in the upper lane of each pair
+		template<int Level>
+		static __m256i partner(__m256i v) noexcept
+		{
+			if constexpr (Level == 0) return _mm256_permute2x128_si256(v, v, 0x01);
+			else if constexpr (Level == 1) return _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+			else return _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+		}
+
+		template<int Level>
+		static __m256i take_upper(__m256i lo, __m256i hi) noexcept
+		{
+			if constexpr (Level == 0) return _mm256_blend_epi32(lo, hi, 0xF0);
+			else if constexpr (Level == 1) return _mm256_blend_epi32(lo, hi, 0xCC);
+			else return _mm256_blend_epi32(lo, hi, 0xAA);
+		}
+
+		static void transpose(__m256i* r) noexcept
+		{
+			__m256i t[8];
+			for (int i = 0; i < 8; i += 2)
+			{
+				t[i]     = _mm256_unpacklo_epi32(r[i], r[i + 1]);
+				t[i + 1] = _mm256_unpackhi_epi32(r[i], r[i + 1]);
+			}
+
+			__m256i u[8];
+			for (int i = 0; i < 8; i += 4)
+			{
+				u[i]     = _mm256_unpacklo_epi64(t[i], t[i + 2]);
+				u[i + 1] = _mm256_unpackhi_epi64(t[i], t[i + 2]);
+				u[i + 2] = _mm256_unpacklo_epi64(t[i + 1], t[i + 3]);
+				u[i + 3] = _mm256_unpackhi_epi64(t[i + 1], t[i + 3]);
+			}
+
+			for (int i = 0; i < 4; ++i)
+			{
+				r[i]     = _mm256_permute2x128_si256(u[i], u[i + 4], 0x20);
+				r[i + 4] = _mm256_permute2x128_si256(u[i], u[i + 4], 0x31);
+			}
+		}
+	};
+
+	// Lane shuffles shared by every 4 x 64-bit element type
+	struct Avx2Lanes64
+	{
+		static constexpr size_t lanes = 4;
+
+		static __m256i reverse(__m256i v) noexcept
+		{
+			return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(0, 1, 2, 3));
+		}
+
+		template<int Level>
+		static __m256i partner(__m256i v) noexcept
+		{
+			if constexpr (Level == 0) return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(1, 0, 3, 2));
+			else return _mm256_permute4x64_epi64(v, _MM_SHUFFLE(2, 3, 0, 1));
+		}
+
+		template<int Level>
+		static __m256i take_upper(__m256i lo, __m256i hi) noexcept
+		{
+			if constexpr (Level == 0) return _mm256_blend_epi32(lo, hi, 0xF0);
+			else return _mm256_blend_epi32(lo, hi, 0xCC);
+		}
+
+		static void transpose(__m256i* r) noexcept
+		{
+			__m256i t0 = _mm256_unpacklo_epi64(r[0], r[1]);
+			__m256i t1 = _mm256_unpackhi_epi64(r[0], r[1]);
+			__m256i t2 = _mm256_unpacklo_epi64(r[2], r[3]);
+			__m256i t3 = _mm256_unpackhi_epi64(r[2], r[3]);
+
+			r[0] = _mm256_permute2x128_si256(t0, t2, 0x20);
+			r[1] = _mm256_permute2x128_si256(t1, t3, 0x20);
+			r[2] = _mm256_permute2x128_si256(t0, t2, 0x31);
+			r[3] = _mm256_permute2x128_si256(t1, t3, 0x31);
+		}
+	};
+
+	template<>
+	struct SimdSortTraits<std::int32_t> : Avx2Lanes32
+	{
+		static constexpr bool enabled = true;
+		using reg = __m256i;
+
+		static reg load(const std::int32_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+		static void store(std::int32_t* p, reg v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		static reg min(reg a, reg b) noexcept { return _mm256_min_epi32(a, b); }
+		static reg max(reg a, reg b) noexcept { return _mm256_max_epi32(a, b); }
+		static __m256i to_bits(reg v) noexcept { return v; }
+		static reg from_bits(__m256i v) noexcept { return v; }
+	};
+
+
+	template<>
+	struct SimdSortTraits<std::int64_t> : Avx2Lanes64
+	{
+		static constexpr bool enabled = true;
+		using reg = __m256i;
+
+		static reg load(const std::int64_t* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+		static void store(std::int64_t* p, reg v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+		static reg min(reg a, reg b) noexcept { return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b)); }
+		static reg max(reg a, reg b) noexcept { return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b)); }
+		static __m256i to_bits(reg v) noexcept { return v; }
+		static reg from_bits(__m256i v) noexcept { return v; }
+	};
+#elif defined(__SSE4_1__)
+	// Lane shuffles shared by every 4 x 32-bit element type
+	struct SseLanes32
+	{
+		static constexpr size_t lanes = 4;
+
+		static __m128i reverse(__m128i v) noexcept
+		{
+			return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+		}
+
+		template<int Level>
+		static __m128i partner(__m128i v) noexcept
+		{
+			if constexpr (Level == 0) return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+			else return _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+		}
+
+		template<int Level>
+		static __m128i take_upper(__m128i lo, __m128i hi) noexcept
+		{
+			if constexpr (Level == 0) return _mm_blend_epi16(lo, hi, 0xF0);
+			else return _mm_blend_epi16(lo, hi, 0xCC);
+		}
+
+		static void transpose(__m128i* r) noexcept
+		{
+			__m128i t0 = _mm_unpacklo_epi32(r[0], r[1]);
+			__m128i t1 = _mm_unpackhi_epi32(r[0], r[1]);
+			__m128i t2 = _mm_unpacklo_epi32(r[2], r[3]);
+			__m128i t3 = _mm_unpackhi_epi32(r[2], r[3]);
+
+			r[0] = _mm_unpacklo_epi64(t0, t2);
+			r[1] = _mm_unpackhi_epi64(t0, t2);
+			r[2] = _mm_unpacklo_epi64(t1, t3);
+			r[3] = _mm_unpackhi_epi64(t1, t3);
+		}
+	};
+
+	template<>
+	struct SimdSortTraits<std::int32_t> : SseLanes32
+	{
+		static constexpr bool enabled = true;
+		using reg = __m128i;
+
+		static reg load(const std::int32_t* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+		static void store(std::int32_t* p, reg v) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+		static reg min(reg a, reg b) noexcept { return _mm_min_epi32(a, b); }
+		static reg max(reg a, reg b) noexcept { return _mm_max_epi32(a, b); }
+		static __m128i to_bits(reg v) noexcept { return v; }
+		static reg from_bits(__m128i v) noexcept { return v; }
+	};
+#endif
+
+	// True when a sort over [Iter) with buffer BufferIter and comparator Cmp can use the kernels:
+	// contiguous storage of a supported type compared by plain less or less_equal
+	template<class Iter, class BufferIter, class Cmp>
+	struct SimdSortable
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		template<class It>
+		static constexpr bool contiguous = std::is_same<It, value_type*>::value
+			|| std::is_same<It, typename std::vector<value_type>::iterator>::value;
+
+		static constexpr bool ascending = std::is_same<Cmp, std::less<>>::value || std::is_same<Cmp, std::less_equal<>>::value
+			|| std::is_same<Cmp, std::less<value_type>>::value || std::is_same<Cmp, std::less_equal<value_type>>::value;
+
+		static constexpr bool value = SimdSortTraits<value_type>::enabled && ascending
+			&& contiguous<Iter> && contiguous<BufferIter>;
+	};
+
+	template<class V, int Level = 0>
+	typename V::reg simd_clean(typename V::reg v) noexcept
+	{
+		if constexpr ((size_t(2) << Level) > V::lanes)
+		{
+			return v;
+		}
+		else
+		{
+			typename V::reg t  = V::from_bits(V::template partner<Level>(V::to_bits(v)));
+			// Lane i and its partner j see the same pair in both calls, so min(v_i, v_j) in lane i and
+			// max(v_i, v_j) in lane j keep one value each even when they compare equal
+			typename V::reg lo = V::min(v, t);
+			typename V::reg hi = V::max(t, v);
+
+			return simd_clean<V, Level + 1>(V::from_bits(V::template take_upper<Level>(V::to_bits(lo), V::to_bits(hi))));
+		}
+	}
+
+	// Sorts a bitonic sequence held in count registers
+	template<class V>
+	void simd_clean_run(typename V::reg* r, size_t count) noexcept
+	{
+		for (size_t stride = count / 2; stride > 0; stride /= 2)
+		{
+			for (size_t block = 0; block < count; block += 2 * stride)
+			{
+				for (size_t i = block; i < block + stride; ++i)
+				{
+					typename V::reg lo = V::min(r[i], r[i + stride]);
+					r[i + stride] = V::max(r[i], r[i + stride]);
+					r[i] = lo;
+				}
+			}
+		}
+
+		for (size_t i = 0; i < count; ++i)
+			r[i] = simd_clean<V>(r[i]);
+	}
+
+	// Bitonic merge of two sorted runs of count registers each; a ends up with the lower half
+	template<class V>
+	void simd_merge_runs(typename V::reg* a, typename V::reg* b, size_t count) noexcept
+	{
+		for (size_t i = 0; i < count / 2; ++i)
+			std::swap(b[i], b[count - 1 - i]);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			b[i] = V::from_bits(V::reverse(V::to_bits(b[i])));
+
+			typename V::reg lo = V::min(a[i], b[i]);
+			b[i] = V::max(a[i], b[i]);
+			a[i] = lo;
+		}
+
+		simd_clean_run<V>(a, count);
+		simd_clean_run<V>(b, count);
+	}
+
+	// Sorts lanes * lanes elements: a sorting network across registers sorts the columns,
+	// a transpose turns them into sorted registers, and bitonic merges join those
+	template<class T>
+	void simd_sort_block(T* p) noexcept
+	{
+		using V = SimdSortTraits<T>;
+		constexpr size_t lanes = V::lanes;
+
+		typename V::reg r[lanes];
+		for (size_t i = 0; i < lanes; ++i)
+			r[i] = V::load(p + i * lanes);
+
+		auto exchange = [&r](size_t i, size_t j)
+		{
+			typename V::reg lo = V::min(r[i], r[j]);
+			r[j] = V::max(r[i], r[j]);
+			r[i] = lo;
+		};
+
+		if constexpr (lanes == 8)
+		{
+			static constexpr unsigned char network[19][2] = {
+				{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+				{ 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 },
+				{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 },
+				{ 2, 4 }, { 3, 5 },
+				{ 1, 4 }, { 3, 6 },
+				{ 1, 2 }, { 3, 4 }, { 5, 6 }
+			};
+
+			for (const auto& pair : network)
+				exchange(pair[0], pair[1]);
+		}
+		else
+		{
+			static constexpr unsigned char network[5][2] = { { 0, 1 }, { 2, 3 }, { 0, 2 }, { 1, 3 }, { 1, 2 } };
+
+			for (const auto& pair : network)
+				exchange(pair[0], pair[1]);
+		}
+
+		using bits_type = decltype(V::to_bits(r[0]));
+
+		bits_type columns[lanes];
+		for (size_t i = 0; i < lanes; ++i)
+			columns[i] = V::to_bits(r[i]);
+
+		V::transpose(columns);
+
+		for (size_t i = 0; i < lanes; ++i)
+			r[i] = V::from_bits(columns[i]);
+
+		for (size_t run = 1; run < lanes; run *= 2)
+		{
+			for (size_t i = 0; i < lanes; i += 2 * run)
+				simd_merge_runs<V>(r + i, r + i + run, run);
+		}
+
+		for (size_t i = 0; i < lanes; ++i)
+			V::store(p + i * lanes, r[i]);
+	}
+
+	// Merges sorted [first, first + first_size) and [second, second + second_size) into out.
+	// out may overlap the second run as long as it starts first_size elements before it.
+	template<class T>
+	void simd_merge(const T* first, size_t first_size, const T* second, size_t second_size, T* out) noexcept
+	{
+		using V = SimdSortTraits<T>;
+		constexpr size_t lanes = V::lanes;
+
+		const T* first_end  = first + first_size;
+		const T* second_end = second + second_size;
+
+		T tail[lanes];
+		const T* tail_start = tail;
+		const T* tail_end   = tail;
+
+		if (first_size >= lanes && second_size >= lanes)
+		{
+			typename V::reg hi = V::load(first);
+			first += lanes;
+
+			// Always pull the next block from the run whose head is smaller, so hi holds
+			// the largest lanes elements seen so far and lo is safe to emit
+			for (;;)
+			{
+				bool first_full  = static_cast<size_t>(first_end - first) >= lanes;
+				bool second_full = static_cast<size_t>(second_end - second) >= lanes;
+				bool take_first;
+
+				if (first_full && second_full)
+					take_first = *first <= *second;
+				else if (first_full || second_full)
+					take_first = first_full;
+				else
+					break;
+
+				// A partly filled run cannot be skipped over
+				if ((take_first && second != second_end && !second_full) || (!take_first && first != first_end && !first_full))
+					break;
+
+				typename V::reg next;
+
+				if (take_first)
+				{
+					next = V::load(first);
+					first += lanes;
+				}
+				else
+				{
+					next = V::load(second);
+					second += lanes;
+				}
+
+				typename V::reg lo = next;
+				simd_merge_runs<V>(&lo, &hi, 1);
+
+				V::store(out, lo);
+				out += lanes;
+			}
+
+			V::store(tail, hi);
+			tail_end = tail + lanes;
+		}
+
+		// At most one block per input is left over; finish with a scalar three-way merge
+		while (tail_start != tail_end || first != first_end || second != second_end)
+		{
+			const T** pick = nullptr;
+			const T*  best = nullptr;
+
+			if (tail_start != tail_end) { pick = &tail_start; best = tail_start; }
+			if (first != first_end && (!best || *first < *best)) { pick = &first; best = first; }
+			if (second != second_end && (!best || *second < *best)) { pick = &second; best = second; }
+
+			*out++ = **pick;
+			++*pick;
+		}
+	}
+}
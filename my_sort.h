@@ -1,82 +1,1391 @@
 #pragma once
+#include "my_simd_sort.h"
+
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace ist
 {
+	// Runs shorter than this are sorted by insertion before merging starts
+	static constexpr ptrdiff_t insertion_sort_threshold = 32;
+
+	// cmp(a, b) tells whether a may stay in front of b; the default less_equal keeps sorts stable
+	template<class Iter, class Cmp = std::less_equal<>>
+	void insertion_sort(Iter start, Iter end, Cmp cmp = std::less_equal<>())
+	{
+		assert(start <= end && "transposed iterator range");
+
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		if (start == end) return;
+
+		for (Iter it = start + 1; it != end; ++it)
+		{
+			if (cmp(*(it - 1), *it)) continue;
+
+			value_type tmp = std::move(*it);
+			Iter hole = it;
+
+			do
+			{
+				*hole = std::move(*(hole - 1));
+				--hole;
+			} while (hole != start && !cmp(*(hole - 1), tmp));
+
+			*hole = std::move(tmp);
+		}
+	}
+
+	// Merges the sorted runs [start, middle) and [middle, end) in place. Only the shorter run
+	// is moved out, so buffer needs room for min(middle - start, end - middle) elements.
+	template<class Iter, class BufferIter, class Cmp>
+	void merge_with_buffer(Iter start, Iter middle, Iter end, BufferIter buffer, Cmp cmp)
+	{
+		if (start == middle || middle == end || cmp(*(middle - 1), *middle)) return;
+
+		if (middle - start <= end - middle)
+		{
+			if constexpr (SimdSortable<Iter, BufferIter, Cmp>::value)
+			{
+				std::move(start, middle, buffer);
+				simd_merge(std::addressof(*buffer), static_cast<size_t>(middle - start),
+					std::addressof(*middle), static_cast<size_t>(end - middle), std::addressof(*start));
+				return;
+			}
+
+			BufferIter buffer_end = std::move(start, middle, buffer);
+			Iter second = middle;
+			Iter out = start;
+
+			while (buffer != buffer_end && second != end)
+			{
+				if (cmp(*buffer, *second))
+					*out++ = std::move(*buffer++);
+				else
+					*out++ = std::move(*second++);
+			}
+
+			std::move(buffer, buffer_end, out);
+		}
+		else
+		{
+			BufferIter buffer_end = std::move(middle, end, buffer);
+			Iter first = middle;
+			Iter out = end;
+
+			while (first != start && buffer_end != buffer)
+			{
+				if (cmp(*(first - 1), *(buffer_end - 1)))
+					*--out = std::move(*--buffer_end);
+				else
+					*--out = std::move(*--first);
+			}
+
+			std::move_backward(buffer, buffer_end, out);
+		}
+	}
+
 	template<class Iter, class Cmp = std::less_equal<>>
 	void merge(Iter first_start, Iter first_end, Iter second_start, Iter second_end, Cmp cmp = std::less_equal<>())
 	{
 		assert(first_start <= first_end && "transposed iterator range");
 		assert(second_start <= second_end && "transposed iterator range");
-		assert(first_start <= second_end && "transposed iterator range");
+		assert(first_end == second_start && "merge needs adjacent ranges");
+
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		std::vector<value_type> buffer(std::min(first_end - first_start, second_end - second_start));
+		merge_with_buffer(first_start, second_start, second_end, buffer.begin(), cmp);
+	}
+
+	// Elements of scratch space merge_sort_buffered needs for a range of n elements
+	constexpr size_t merge_sort_buffer_size(size_t n) noexcept
+	{
+		return n / 2;
+	}
+
+	// Bottom-up merge sort that never allocates; buffer must hold merge_sort_buffer_size(end - start) elements
+	template<class Iter, class BufferIter, class Cmp = std::less_equal<>>
+	void merge_sort_buffered(Iter start, Iter end, BufferIter buffer, Cmp cmp = std::less_equal<>())
+	{
+		assert(start <= end && "transposed iterator range");
+
+		ptrdiff_t n   = end - start;
+		ptrdiff_t run = insertion_sort_threshold;
+
+		// Plain keys get their first runs from the register sorting network instead
+		if constexpr (SimdSortable<Iter, BufferIter, Cmp>::value)
+		{
+			using traits = SimdSortTraits<typename std::iterator_traits<Iter>::value_type>;
+			run = static_cast<ptrdiff_t>(traits::lanes * traits::lanes);
+
+			for (ptrdiff_t lo = 0; lo + run <= n; lo += run)
+				simd_sort_block(std::addressof(start[lo]));
+
+			insertion_sort(start + (n - n % run), end, cmp);
+		}
+		else
+		{
+			for (ptrdiff_t lo = 0; lo < n; lo += run)
+				insertion_sort(start + lo, start + std::min(lo + run, n), cmp);
+		}
+
+		for (ptrdiff_t width = run; width < n; width *= 2)
+		{
+			for (ptrdiff_t lo = 0; lo < n - width; lo += 2 * width)
+				merge_with_buffer(start + lo, start + lo + width, start + std::min(lo + 2 * width, n), buffer, cmp);
+		}
+	}
+
+	template<class Iter, class Cmp = std::less_equal<>>
+	void merge_sort(Iter start, Iter end, Cmp cmp = std::less_equal<>())
+	{
+		assert(start <= end && "transposed iterator range");
+
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		if (end - start <= insertion_sort_threshold)
+		{
+			insertion_sort(start, end, cmp);
+			return;
+		}
+
+		std::vector<value_type> buffer(merge_sort_buffer_size(static_cast<size_t>(end - start)));
+		merge_sort_buffered(start, end, buffer.begin(), cmp);
+	}
+
+	// Partitions below this size are finished by insertion sort
+	static constexpr ptrdiff_t quick_sort_insertion_threshold = 24;
+
+	// Above this size the pivot is a ninther, the median of three medians of three
+	static constexpr ptrdiff_t quick_sort_ninther_threshold = 128;
+
+	// Element moves after which partial_insertion_sort gives up on a nearly sorted partition
+	static constexpr ptrdiff_t partial_insertion_sort_limit = 8;
+
+	// Elements scanned per side and block during branch-free partitioning; offsets must fit a byte
+	static constexpr ptrdiff_t partition_block_size = 64;
+
+	// Strict "a goes before b" from a cmp that may be either kind: a merge_sort-style cmp, which
+	// tells whether a may stay in front of b, or a strict one like a < b. probe() tells them apart
+	// by comparing an element with itself. The standard comparators need no probe, and only they
+	// are trusted to be asymmetric, which the unguarded insertion sort relies on.
+	template<class Cmp>
+	struct StrictOrder
+	{
+		static constexpr bool asymmetric = false;
+
+		Cmp  cmp;
+		bool strict = false;
+
+		template<class T>
+		void probe(const T& value)
+		{
+			strict = !cmp(value, value);
+		}
+
+		template<class A, class B>
+		bool operator()(const A& a, const B& b)
+		{
+			return strict ? cmp(a, b) : !cmp(b, a);
+		}
+	};
 
-		using value_type = typename Iter::value_type;
+	template<class Op, class Less>
+	struct StandardStrictOrder
+	{
+		static constexpr bool asymmetric = true;
 
-		std::vector<value_type> tmp(second_end - first_start);
+		Op cmp;
 
-		size_t index = 0;
-		Iter start = first_start;
-		Iter end = second_end;
+		template<class T>
+		void probe(const T&) noexcept {}
 
-		while (first_start != first_end && second_start != second_end)
+		// less_equal and greater_equal use their strict counterparts, which stay asymmetric for NaN
+		template<class A, class B>
+		bool operator()(const A& a, const B& b)
 		{
-			if (cmp(*first_start, *second_start))
+			return Less()(a, b);
+		}
+	};
+
+	template<class T>
+	struct StrictOrder<std::less<T>> : StandardStrictOrder<std::less<T>, std::less<T>> {};
+
+	template<class T>
+	struct StrictOrder<std::less_equal<T>> : StandardStrictOrder<std::less_equal<T>, std::less<T>> {};
+
+	template<class T>
+	struct StrictOrder<std::greater<T>> : StandardStrictOrder<std::greater<T>, std::greater<T>> {};
+
+	template<class T>
+	struct StrictOrder<std::greater_equal<T>> : StandardStrictOrder<std::greater_equal<T>, std::greater<T>> {};
+
+	// Block partitioning pays off when comparisons are cheap enough to compute
+	// unconditionally: plain numbers under one of the standard comparators
+	template<class Iter, class Cmp>
+	struct BlockPartitionable
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		template<template<class> class Op>
+		static constexpr bool is = std::is_same<Cmp, Op<void>>::value || std::is_same<Cmp, Op<value_type>>::value;
+
+		static constexpr bool value = (std::is_arithmetic<value_type>::value || std::is_pointer<value_type>::value)
+			&& (is<std::less> || is<std::less_equal> || is<std::greater> || is<std::greater_equal>);
+	};
+
+	template<class Iter, class Less>
+	void sort2(Iter a, Iter b, Less& less)
+	{
+		if (less(*b, *a)) std::iter_swap(a, b);
+	}
+
+	template<class Iter, class Less>
+	void sort3(Iter a, Iter b, Iter c, Less& less)
+	{
+		sort2(a, b, less);
+		sort2(b, c, less);
+		sort2(a, b, less);
+	}
+
+	// Insertion sort without the lower bound check; *(start - 1) must not be greater than any element
+	template<class Iter, class Less>
+	void unguarded_insertion_sort(Iter start, Iter end, Less& less)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		for (Iter it = start + 1; it < end; ++it)
+		{
+			if (!less(*it, *(it - 1))) continue;
+
+			value_type tmp = std::move(*it);
+			Iter hole = it;
+
+			do
 			{
-				tmp[index] = *first_start;
-				++first_start;
-				++index;
+				*hole = std::move(*(hole - 1));
+				--hole;
+			} while (less(tmp, *(hole - 1)));
+
+			*hole = std::move(tmp);
+		}
+	}
+
+	// Insertion sort that gives up once it has moved more than partial_insertion_sort_limit
+	// elements; returns whether the range ended up sorted
+	template<class Iter, class Less>
+	bool partial_insertion_sort(Iter start, Iter end, Less& less)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		ptrdiff_t moves = 0;
+
+		for (Iter it = start + 1; it < end; ++it)
+		{
+			if (!less(*it, *(it - 1))) continue;
+
+			value_type tmp = std::move(*it);
+			Iter hole = it;
+
+			do
+			{
+				*hole = std::move(*(hole - 1));
+				--hole;
+			} while (hole != start && less(tmp, *(hole - 1)));
+
+			*hole = std::move(tmp);
+
+			moves += it - hole;
+			if (moves > partial_insertion_sort_limit) return false;
+		}
+
+		return true;
+	}
+
+	// Puts elements equal to the pivot *start on its left and greater ones on its right. Used when
+	// the pivot equals the element just before the range, so the left side needs no more sorting.
+	template<class Iter, class Less>
+	Iter partition_left(Iter start, Iter end, Less& less)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		value_type pivot = std::move(*start);
+		Iter first = start;
+		Iter last = end;
+
+		// The first scans stay bounded in case less is not a strict order
+		while (--last != start && less(pivot, *last));
+
+		while (first < last && !less(pivot, *++first));
+
+		while (first < last)
+		{
+			std::iter_swap(first, last);
+			while (less(pivot, *--last));
+			while (!less(pivot, *++first));
+		}
+
+		*start = std::move(*last);
+		*last = std::move(pivot);
+
+		return last;
+	}
+
+	// Partitions around the pivot *start: smaller elements go left, greater or equal ones right.
+	// Returns the pivot's final place and whether no element had to be swapped.
+	template<class Iter, class Less>
+	std::pair<Iter, bool> partition_right(Iter start, Iter end, Less& less)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		value_type pivot = std::move(*start);
+		Iter first = start;
+		Iter last = end;
+
+		// The first scans stay bounded in case less is not a strict order; the swaps below
+		// then leave a sentinel for every later scan
+		while (++first != end && less(*first, pivot));
+
+		while (first < last && !less(*--last, pivot));
+
+		bool already_partitioned = first >= last;
+
+		while (first < last)
+		{
+			std::iter_swap(first, last);
+			while (less(*++first, pivot));
+			while (!less(*--last, pivot));
+		}
+
+		Iter pivot_pos = first - 1;
+		*start = std::move(*pivot_pos);
+		*pivot_pos = std::move(pivot);
+
+		return { pivot_pos, already_partitioned };
+	}
+
+	// Swaps the misplaced elements recorded at left and right offsets. A cyclic permutation
+	// needs fewer moves, but equal counts on both sides must swap to keep descending input linear.
+	template<class Iter>
+	void swap_offsets(Iter left_base, Iter right_base, const unsigned char* left, const unsigned char* right, ptrdiff_t count, bool use_swaps)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		if (use_swaps)
+		{
+			for (ptrdiff_t i = 0; i < count; ++i)
+				std::iter_swap(left_base + left[i], right_base - right[i]);
+		}
+		else if (count > 0)
+		{
+			Iter l = left_base + left[0];
+			Iter r = right_base - right[0];
+			value_type tmp = std::move(*l);
+			*l = std::move(*r);
+
+			for (ptrdiff_t i = 1; i < count; ++i)
+			{
+				l = left_base + left[i];
+				*r = std::move(*l);
+				r = right_base - right[i];
+				*l = std::move(*r);
 			}
-			else
+
+			*r = std::move(tmp);
+		}
+	}
+
+	// partition_right without data-dependent branches in the scan: each side records the offsets
+	// of misplaced elements for a whole block, and those are swapped pairwise afterwards
+	template<class Iter, class Less>
+	std::pair<Iter, bool> partition_right_block(Iter start, Iter end, Less& less)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		value_type pivot = std::move(*start);
+		Iter first = start;
+		Iter last = end;
+
+		while (++first != end && less(*first, pivot));
+
+		while (first < last && !less(*--last, pivot));
+
+		bool already_partitioned = first >= last;
+
+		if (!already_partitioned)
+		{
+			std::iter_swap(first, last);
+			++first;
+
+			alignas(64) unsigned char left_offsets[partition_block_size];
+			alignas(64) unsigned char right_offsets[partition_block_size];
+
+			Iter left_base = first;
+			Iter right_base = last;
+			ptrdiff_t left_count = 0, right_count = 0;
+			ptrdiff_t left_start = 0, right_start = 0;
+
+			while (first < last)
 			{
-				tmp[index] = *second_start;
-				++second_start;
-				++index;
+				// Only a side whose block is used up scans again; near the end the unknown
+				// elements are split between the sides that need them
+				ptrdiff_t unknown = last - first;
+				ptrdiff_t left_split = left_count == 0 ? (right_count == 0 ? unknown / 2 : unknown) : 0;
+				ptrdiff_t right_split = right_count == 0 ? unknown - left_split : 0;
+
+				left_split = std::min(left_split, partition_block_size);
+				right_split = std::min(right_split, partition_block_size);
+
+				for (ptrdiff_t i = 0; i < left_split; ++i)
+				{
+					left_offsets[left_count] = static_cast<unsigned char>(i);
+					left_count += !less(*first, pivot);
+					++first;
+				}
+
+				for (ptrdiff_t i = 0; i < right_split;)
+				{
+					right_offsets[right_count] = static_cast<unsigned char>(++i);
+					right_count += less(*--last, pivot);
+				}
+
+				ptrdiff_t count = std::min(left_count, right_count);
+				swap_offsets(left_base, right_base, left_offsets + left_start, right_offsets + right_start, count, left_count == right_count);
+
+				left_count -= count;
+				right_count -= count;
+				left_start += count;
+				right_start += count;
+
+				if (left_count == 0)
+				{
+					left_start = 0;
+					left_base = first;
+				}
+
+				if (right_count == 0)
+				{
+					right_start = 0;
+					right_base = last;
+				}
+			}
+
+			// One side may still hold misplaced elements; they move to the boundary
+			if (left_count != 0)
+			{
+				while (left_count--)
+					std::iter_swap(left_base + left_offsets[left_start + left_count], --last);
+
+				first = last;
+			}
+
+			if (right_count != 0)
+			{
+				while (right_count--)
+					std::iter_swap(right_base - right_offsets[right_start + right_count], first++);
+
+				last = first;
 			}
 		}
 
-		while (first_start != first_end)
+		Iter pivot_pos = first - 1;
+		*start = std::move(*pivot_pos);
+		*pivot_pos = std::move(pivot);
+
+		return { pivot_pos, already_partitioned };
+	}
+
+	// Moves the pivot to *start: the median of three, or above quick_sort_ninther_threshold the
+	// median of three medians. Either way an element not smaller than the pivot ends up at end - 1.
+	template<class Iter, class Less>
+	void choose_pivot(Iter start, Iter end, Less& less)
+	{
+		ptrdiff_t n = end - start;
+		ptrdiff_t half = n / 2;
+
+		if (n > quick_sort_ninther_threshold)
+		{
+			sort3(start, start + half, end - 1, less);
+			sort3(start + 1, start + (half - 1), end - 2, less);
+			sort3(start + 2, start + (half + 1), end - 3, less);
+			sort3(start + (half - 1), start + half, start + (half + 1), less);
+			std::iter_swap(start, start + half);
+		}
+		else
 		{
-			tmp[index] = *first_start;
-			++first_start;
-			++index;
+			sort3(start + half, start, end - 1, less);
 		}
+	}
+
+	// After a badly unbalanced partition, swaps a few elements of both sides to break up
+	// the pattern that produced the bad pivot
+	template<class Iter>
+	void break_patterns(Iter start, Iter pivot_pos, Iter end)
+	{
+		ptrdiff_t left_size = pivot_pos - start;
+		ptrdiff_t right_size = end - (pivot_pos + 1);
 
-		while (second_start != second_end)
+		if (left_size >= quick_sort_insertion_threshold)
 		{
-			tmp[index] = *second_start;
-			++second_start;
-			++index;
+			std::iter_swap(start, start + left_size / 4);
+			std::iter_swap(pivot_pos - 1, pivot_pos - left_size / 4);
+
+			if (left_size > quick_sort_ninther_threshold)
+			{
+				std::iter_swap(start + 1, start + (left_size / 4 + 1));
+				std::iter_swap(start + 2, start + (left_size / 4 + 2));
+				std::iter_swap(pivot_pos - 2, pivot_pos - (left_size / 4 + 1));
+				std::iter_swap(pivot_pos - 3, pivot_pos - (left_size / 4 + 2));
+			}
+		}
+
+		if (right_size >= quick_sort_insertion_threshold)
+		{
+			std::iter_swap(pivot_pos + 1, pivot_pos + (1 + right_size / 4));
+			std::iter_swap(end - 1, end - right_size / 4);
+
+			if (right_size > quick_sort_ninther_threshold)
+			{
+				std::iter_swap(pivot_pos + 2, pivot_pos + (2 + right_size / 4));
+				std::iter_swap(pivot_pos + 3, pivot_pos + (3 + right_size / 4));
+				std::iter_swap(end - 2, end - (1 + right_size / 4));
+				std::iter_swap(end - 3, end - (2 + right_size / 4));
+			}
 		}
+	}
 
-		index = 0;
-		while (start != end)
+	template<bool Block, class Iter, class Less>
+	void quick_sort_step(Iter start, Iter end, Less& less, int bad_allowed, bool leftmost)
+	{
+		// The larger side is handled by the loop; good partitions keep the recursion at O(log n)
+		for (;;)
 		{
-			*start = tmp[index++];
-			++start;
+			ptrdiff_t n = end - start;
+
+			if (n < quick_sort_insertion_threshold)
+			{
+				if (leftmost || !Less::asymmetric)
+					insertion_sort(start, end, [&less](const auto& a, const auto& b) { return !less(b, a); });
+				else
+					unguarded_insertion_sort(start, end, less);
+
+				return;
+			}
+
+			choose_pivot(start, end, less);
+
+			// No element here is smaller than *(start - 1), the pivot of an earlier partition. A pivot
+			// equal to it means a run of equal keys: gather them on the left, which is then done.
+			if (!leftmost && !less(*(start - 1), *start))
+			{
+				start = partition_left(start, end, less) + 1;
+				continue;
+			}
+
+			std::pair<Iter, bool> part = Block ? partition_right_block(start, end, less) : partition_right(start, end, less);
+			Iter pivot_pos = part.first;
+
+			ptrdiff_t left_size = pivot_pos - start;
+			ptrdiff_t right_size = end - (pivot_pos + 1);
+
+			if (left_size < n / 8 || right_size < n / 8)
+			{
+				// Too many bad pivots: heap sort bounds the rest at O(n log n)
+				if (--bad_allowed == 0)
+				{
+					std::make_heap(start, end, less);
+					std::sort_heap(start, end, less);
+					return;
+				}
+
+				break_patterns(start, pivot_pos, end);
+			}
+			else if (part.second && partial_insertion_sort(start, pivot_pos, less) && partial_insertion_sort(pivot_pos + 1, end, less))
+			{
+				// A balanced partition that swapped nothing suggests sorted input
+				return;
+			}
+
+			if (left_size < right_size)
+			{
+				quick_sort_step<Block>(start, pivot_pos, less, bad_allowed, leftmost);
+				start = pivot_pos + 1;
+				leftmost = false;
+			}
+			else
+			{
+				quick_sort_step<Block>(pivot_pos + 1, end, less, bad_allowed, false);
+				end = pivot_pos;
+			}
 		}
 	}
 
+	// Unstable in-place sort after pattern-defeating quicksort: ninther pivots, branch-free block
+	// partitioning for plain numbers, a heap sort fallback and linear time on sorted, reverse sorted
+	// and all-equal input. cmp may be merge_sort-style or strict like a < b; extra space is O(log n).
 	template<class Iter, class Cmp = std::less_equal<>>
-	void merge_sort(Iter start, Iter end, Cmp cmp = std::less_equal<>())
+	void quick_sort(Iter start, Iter end, Cmp cmp = std::less_equal<>())
 	{
 		assert(start <= end && "transposed iterator range");
 
 		if (end - start < 2) return;
 
-		Iter middle = start;
-		middle += (end - start) / 2;
+		StrictOrder<Cmp> less{ cmp };
+		less.probe(*start);
+
+		// Sorted and strictly descending input is finished in one pass
+		Iter run = start + 1;
+		while (run != end && !less(*run, *(run - 1))) ++run;
+		if (run == end) return;
+
+		if (run == start + 1)
+		{
+			while (run != end && less(*run, *(run - 1))) ++run;
+
+			if (run == end)
+			{
+				std::reverse(start, end);
+				return;
+			}
+		}
+
+		int bad_allowed = 1;
+		for (ptrdiff_t n = end - start; n > 1; n >>= 1)
+			bad_allowed += 1;
+
+		quick_sort_step<BlockPartitionable<Iter, Cmp>::value>(start, end, less, bad_allowed, true);
+	}
+
+	// Introselect: partitions like quick_sort but only follows the side holding nth, so on average
+	// it runs in linear time. Afterwards *nth is the element a full sort would put there, nothing
+	// before it goes after it and nothing after it goes before it.
+	template<class Iter, class Cmp = std::less_equal<>>
+	void nth_element(Iter start, Iter nth, Iter end, Cmp cmp = std::less_equal<>())
+	{
+		assert(start <= nth && nth <= end && "nth outside the iterator range");
+
+		if (nth == end) return;
+
+		StrictOrder<Cmp> less{ cmp };
+		less.probe(*start);
+		bool leftmost = true;
+
+		int bad_allowed = 1;
+		for (ptrdiff_t n = end - start; n > 1; n >>= 1)
+			bad_allowed += 1;
+
+		while (end - start >= quick_sort_insertion_threshold)
+		{
+			ptrdiff_t n = end - start;
+			choose_pivot(start, end, less);
+
+			if (!leftmost && !less(*(start - 1), *start))
+			{
+				Iter equal_end = partition_left(start, end, less) + 1;
+				if (nth < equal_end) return;
+
+				start = equal_end;
+				continue;
+			}
+
+			Iter pivot_pos = BlockPartitionable<Iter, Cmp>::value ? partition_right_block(start, end, less).first : partition_right(start, end, less).first;
+
+			if (pivot_pos - start < n / 8 || end - (pivot_pos + 1) < n / 8)
+			{
+				// Too many bad pivots: finish with a heap sort, O(n log n) at worst
+				if (--bad_allowed == 0)
+				{
+					std::make_heap(start, end, less);
+					std::sort_heap(start, end, less);
+					return;
+				}
+
+				break_patterns(start, pivot_pos, end);
+			}
+
+			if (pivot_pos == nth) return;
 
-		Iter first_start = start;
-		Iter first_end = middle;
+			if (nth < pivot_pos)
+			{
+				end = pivot_pos;
+			}
+			else
+			{
+				start = pivot_pos + 1;
+				leftmost = false;
+			}
+		}
+
+		if (leftmost || !StrictOrder<Cmp>::asymmetric)
+			insertion_sort(start, end, [&less](const auto& a, const auto& b) { return !less(b, a); });
+		else
+			unguarded_insertion_sort(start, end, less);
+	}
+
+	// Sorts the middle - start smallest elements into [start, middle) in O(n + k log k);
+	// the order of the rest is unspecified
+	template<class Iter, class Cmp = std::less_equal<>>
+	void partial_sort(Iter start, Iter middle, Iter end, Cmp cmp = std::less_equal<>())
+	{
+		assert(start <= middle && middle <= end && "middle outside the iterator range");
+
+		if (start == middle) return;
+
+		ist::nth_element(start, middle - 1, end, cmp);
+		ist::quick_sort(start, middle - 1, cmp);
+	}
+
+	// Arrays shorter than this are sorted by binary insertion alone; natural runs are extended to
+	// a minimum length between tim_sort_min_merge / 2 and tim_sort_min_merge
+	static constexpr ptrdiff_t tim_sort_min_merge = 64;
+
+	// Consecutive wins by one run after which a merge switches to galloping
+	static constexpr ptrdiff_t tim_sort_min_gallop = 7;
+
+	// Length of the natural run at start, which is reversed in place if it is strictly descending
+	template<class Iter, class Cmp>
+	ptrdiff_t count_run(Iter start, Iter end, Cmp& cmp)
+	{
+		Iter run = start + 1;
+		if (run == end) return 1;
+
+		if (cmp(*start, *run))
+		{
+			while (++run != end && cmp(*(run - 1), *run));
+		}
+		else
+		{
+			while (++run != end && !cmp(*(run - 1), *run));
+			std::reverse(start, run);
+		}
+
+		return run - start;
+	}
+
+	// Extends the sorted prefix [start, sorted_end) to the whole range, finding each insertion point
+	// by binary search after any equal elements
+	template<class Iter, class Cmp>
+	void binary_insertion_sort(Iter start, Iter sorted_end, Iter end, Cmp& cmp)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		for (Iter it = sorted_end; it != end; ++it)
+		{
+			Iter pos = std::partition_point(start, it, [&](const value_type& value) { return cmp(value, *it); });
+			if (pos == it) continue;
+
+			value_type tmp = std::move(*it);
+			std::move_backward(pos, it, it + 1);
+			*pos = std::move(tmp);
+		}
+	}
+
+	// Length of the prefix of [first, first + len) for which pred holds, pred being true on a prefix.
+	// Probes 1, 3, 7, ... elements in before a binary search, so a short prefix is found quickly.
+	template<class Iter, class Pred>
+	ptrdiff_t gallop_front(Iter first, ptrdiff_t len, Pred pred)
+	{
+		ptrdiff_t lo = 0;
+		ptrdiff_t hi = 1;
+
+		while (hi <= len && pred(first[hi - 1]))
+		{
+			lo = hi;
+			hi = 2 * hi + 1;
+		}
+
+		hi = std::min(hi, len);
+		return std::partition_point(first + lo, first + hi, pred) - first;
+	}
+
+	// Length of the suffix of [first, first + len) for which pred fails, probing from the back
+	template<class Iter, class Pred>
+	ptrdiff_t gallop_back(Iter first, ptrdiff_t len, Pred pred)
+	{
+		ptrdiff_t lo = 0;
+		ptrdiff_t hi = 1;
+
+		while (hi <= len && !pred(first[len - hi]))
+		{
+			lo = hi;
+			hi = 2 * hi + 1;
+		}
+
+		hi = std::min(hi, len);
+		return len - (std::partition_point(first + (len - hi), first + (len - lo), pred) - first);
+	}
+
+	// Run stack and merge machinery of tim_sort. Pending runs keep lengths that shrink faster than
+	// the Fibonacci numbers, so the stack stays O(log n) deep and merges stay balanced.
+	template<class Iter, class Cmp>
+	class TimSortRuns
+	{
+	public:
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+	public:
+		explicit TimSortRuns(Cmp& cmp)
+			: cmp_(cmp), min_gallop_(tim_sort_min_gallop) {}
+
+		void push(Iter base, ptrdiff_t len)
+		{
+			runs_.push_back({ base, len });
+			merge_collapse();
+		}
+
+		// Merges whatever is left once the input is used up
+		void merge_force()
+		{
+			while (runs_.size() > 1)
+			{
+				size_t n = runs_.size() - 2;
+				if (n > 0 && runs_[n - 1].len < runs_[n + 1].len) --n;
+
+				merge_at(n);
+			}
+		}
+
+	private:
+		struct run
+		{
+			Iter      base;
+			ptrdiff_t len;
+		};
+
+		// Restores len[i - 2] > len[i - 1] + len[i] and len[i - 1] > len[i] over the top four runs
+		void merge_collapse()
+		{
+			while (runs_.size() > 1)
+			{
+				size_t n = runs_.size() - 2;
 
-		Iter second_start = middle;
-		Iter second_end = end;
+				if ((n > 0 && runs_[n - 1].len <= runs_[n].len + runs_[n + 1].len)
+					|| (n > 1 && runs_[n - 2].len <= runs_[n - 1].len + runs_[n].len))
+				{
+					if (runs_[n - 1].len < runs_[n + 1].len) --n;
+				}
+				else if (runs_[n].len > runs_[n + 1].len)
+				{
+					break;
+				}
 
-		merge_sort(first_start, first_end);
-		merge_sort(second_start, second_end);
+				merge_at(n);
+			}
+		}
+
+		void merge_at(size_t i)
+		{
+			Iter base1 = runs_[i].base;
+			Iter base2 = runs_[i + 1].base;
+			ptrdiff_t len1 = runs_[i].len;
+			ptrdiff_t len2 = runs_[i + 1].len;
+
+			runs_[i].len = len1 + len2;
+			if (i + 3 == runs_.size()) runs_[i + 1] = runs_[i + 2];
+			runs_.pop_back();
+
+			// The head of run 1 that may stay before run 2's first element is already in place
+			ptrdiff_t skip = gallop_front(base1, len1, [&](const value_type& value) { return cmp_(value, *base2); });
+			base1 += skip;
+			len1 -= skip;
+			if (len1 == 0) return;
+
+			// So is the tail of run 2 that may stay after run 1's last element
+			const value_type& last1 = base1[len1 - 1];
+			len2 -= gallop_back(base2, len2, [&](const value_type& value) { return !cmp_(last1, value); });
+			if (len2 == 0) return;
+
+			if (len1 <= len2)
+				merge_lo(base1, len1, base2, len2);
+			else
+				merge_hi(base1, len1, base2, len2);
+		}
+
+		// Merges forward with run 1 moved out; run 2 starts with an element that goes before all of
+		// run 1 and run 1 ends with one that goes after all of run 2
+		void merge_lo(Iter base1, ptrdiff_t len1, Iter base2, ptrdiff_t len2)
+		{
+			if (buffer_.size() < static_cast<size_t>(len1)) buffer_.resize(static_cast<size_t>(len1));
+
+			auto tmp = buffer_.begin();
+			std::move(base1, base1 + len1, tmp);
+
+			ptrdiff_t i1 = 0, i2 = 0, dest = 0;
+			ptrdiff_t min_gallop = min_gallop_;
+
+			base1[dest++] = std::move(base2[i2++]);
+			--len2;
+
+			while (len2 != 0 && len1 > 1)
+			{
+				ptrdiff_t wins1 = 0, wins2 = 0;
+
+				// One element at a time until a run keeps winning
+				while (len2 != 0 && len1 > 1 && std::max(wins1, wins2) < min_gallop)
+				{
+					if (!cmp_(tmp[i1], base2[i2]))
+					{
+						base1[dest++] = std::move(base2[i2++]);
+						--len2;
+						++wins2;
+						wins1 = 0;
+					}
+					else
+					{
+						base1[dest++] = std::move(tmp[i1++]);
+						--len1;
+						++wins1;
+						wins2 = 0;
+					}
+				}
+
+				// Then in bulk, for as long as the gallops pay off
+				while (len2 != 0 && len1 > 1)
+				{
+					wins1 = gallop_front(tmp + i1, len1, [&](const value_type& value) { return cmp_(value, base2[i2]); });
+					std::move(tmp + i1, tmp + (i1 + wins1), base1 + dest);
+					dest += wins1;
+					i1 += wins1;
+					len1 -= wins1;
+					if (len1 <= 1) break;
+
+					base1[dest++] = std::move(base2[i2++]);
+					if (--len2 == 0) break;
+
+					wins2 = gallop_front(base2 + i2, len2, [&](const value_type& value) { return !cmp_(tmp[i1], value); });
+					std::move(base2 + i2, base2 + (i2 + wins2), base1 + dest);
+					dest += wins2;
+					i2 += wins2;
+					len2 -= wins2;
+					if (len2 == 0) break;
+
+					base1[dest++] = std::move(tmp[i1++]);
+					if (--len1 == 1) break;
+
+					if (min_gallop > 0) --min_gallop;
+					if (wins1 < tim_sort_min_gallop && wins2 < tim_sort_min_gallop) break;
+				}
+
+				// Leaving gallop mode makes entering it again harder
+				min_gallop += 2;
+			}
+
+			min_gallop_ = std::max<ptrdiff_t>(min_gallop, 1);
+
+			assert(len1 > 0 && "tim_sort comparator is not a consistent ordering");
+
+			if (len1 == 1)
+			{
+				std::move(base2 + i2, base2 + (i2 + len2), base1 + dest);
+				base1[dest + len2] = std::move(tmp[i1]);
+			}
+			else
+			{
+				std::move(tmp + i1, tmp + (i1 + len1), base1 + dest);
+			}
+		}
+
+		// Mirror image of merge_lo: run 2 is moved out and the merge runs backwards from the end
+		void merge_hi(Iter base1, ptrdiff_t len1, Iter base2, ptrdiff_t len2)
+		{
+			if (buffer_.size() < static_cast<size_t>(len2)) buffer_.resize(static_cast<size_t>(len2));
+
+			auto tmp = buffer_.begin();
+			std::move(base2, base2 + len2, tmp);
+
+			ptrdiff_t i1 = len1 - 1, i2 = len2 - 1, dest = len1 + len2 - 1;
+			ptrdiff_t min_gallop = min_gallop_;
+
+			base1[dest--] = std::move(base1[i1--]);
+			--len1;
+
+			while (len1 != 0 && len2 > 1)
+			{
+				ptrdiff_t wins1 = 0, wins2 = 0;
+
+				while (len1 != 0 && len2 > 1 && std::max(wins1, wins2) < min_gallop)
+				{
+					if (!cmp_(base1[i1], tmp[i2]))
+					{
+						base1[dest--] = std::move(base1[i1--]);
+						--len1;
+						++wins1;
+						wins2 = 0;
+					}
+					else
+					{
+						base1[dest--] = std::move(tmp[i2--]);
+						--len2;
+						++wins2;
+						wins1 = 0;
+					}
+				}
+
+				while (len1 != 0 && len2 > 1)
+				{
+					wins1 = gallop_back(base1 + (i1 + 1 - len1), len1, [&](const value_type& value) { return cmp_(value, tmp[i2]); });
+					std::move_backward(base1 + (i1 + 1 - wins1), base1 + (i1 + 1), base1 + (dest + 1));
+					dest -= wins1;
+					i1 -= wins1;
+					len1 -= wins1;
+					if (len1 == 0) break;
+
+					base1[dest--] = std::move(tmp[i2--]);
+					if (--len2 == 1) break;
+
+					wins2 = gallop_back(tmp + (i2 + 1 - len2), len2, [&](const value_type& value) { return !cmp_(base1[i1], value); });
+					std::move_backward(tmp + (i2 + 1 - wins2), tmp + (i2 + 1), base1 + (dest + 1));
+					dest -= wins2;
+					i2 -= wins2;
+					len2 -= wins2;
+					if (len2 <= 1) break;
+
+					base1[dest--] = std::move(base1[i1--]);
+					if (--len1 == 0) break;
+
+					if (min_gallop > 0) --min_gallop;
+					if (wins1 < tim_sort_min_gallop && wins2 < tim_sort_min_gallop) break;
+				}
+
+				min_gallop += 2;
+			}
+
+			min_gallop_ = std::max<ptrdiff_t>(min_gallop, 1);
+
+			assert(len2 > 0 && "tim_sort comparator is not a consistent ordering");
+
+			if (len2 == 1)
+			{
+				std::move_backward(base1 + (i1 + 1 - len1), base1 + (i1 + 1), base1 + (dest + 1));
+				base1[dest - len1] = std::move(tmp[i2]);
+			}
+			else
+			{
+				std::move(tmp, tmp + len2, base1 + (dest + 1 - len2));
+			}
+		}
+
+	private:
+		Cmp&                    cmp_;
+		ptrdiff_t               min_gallop_;
+		std::vector<run>        runs_;
+		std::vector<value_type> buffer_;
+	};
+
+	// Stable adaptive merge sort after TimSort: natural ascending and strictly descending runs are
+	// found and extended to a minimum length by binary insertion, then merged with galloping.
+	// Sorted or nearly sorted input takes close to linear time.
+	template<class Iter, class Cmp = std::less_equal<>>
+	void tim_sort(Iter start, Iter end, Cmp cmp = std::less_equal<>())
+	{
+		assert(start <= end && "transposed iterator range");
 
-		merge(first_start, first_end, second_start, second_end, cmp);
+		ptrdiff_t n = end - start;
+		if (n < 2) return;
+
+		if (n < tim_sort_min_merge)
+		{
+			binary_insertion_sort(start, start + count_run(start, end, cmp), end, cmp);
+			return;
+		}
+
+		ptrdiff_t min_run = n;
+		ptrdiff_t odd = 0;
+
+		while (min_run >= tim_sort_min_merge)
+		{
+			odd |= min_run & 1;
+			min_run >>= 1;
+		}
+
+		min_run += odd;
+
+		TimSortRuns<Iter, Cmp> runs(cmp);
+
+		for (Iter run = start; run != end;)
+		{
+			ptrdiff_t len = count_run(run, end, cmp);
+
+			if (len < min_run)
+			{
+				ptrdiff_t forced = std::min(min_run, end - run);
+				binary_insertion_sort(run, run + len, run + forced, cmp);
+				len = forced;
+			}
+
+			runs.push(run, len);
+			run += len;
+		}
+
+		runs.merge_force();
+	}
+
+	struct identity_key
+	{
+		template<class T>
+		constexpr const T& operator()(const T& value) const noexcept
+		{
+			return value;
+		}
+	};
+
+	// Maps an integer or IEEE float onto an unsigned integer with the same ordering:
+	// signed integers get their sign bit flipped, negative floats have every bit inverted
+	template<class Key>
+	auto radix_bits(Key key) noexcept
+	{
+		static_assert(std::is_arithmetic<Key>::value && !std::is_same<Key, bool>::value, "radix keys must be integers or floats");
+
+		if constexpr (std::is_floating_point<Key>::value)
+		{
+			static_assert(sizeof(Key) == 4 || sizeof(Key) == 8, "radix sort supports 32 and 64 bit floats");
+
+			using bits_type = std::conditional_t<sizeof(Key) == 4, std::uint32_t, std::uint64_t>;
+			const bits_type sign = bits_type(1) << (sizeof(Key) * 8 - 1);
+
+			bits_type bits;
+			std::memcpy(&bits, &key, sizeof(Key));
+
+			return static_cast<bits_type>(bits & sign ? ~bits : bits | sign);
+		}
+		else
+		{
+			using bits_type = std::make_unsigned_t<Key>;
+
+			if constexpr (std::is_signed<Key>::value)
+				return static_cast<bits_type>(static_cast<bits_type>(key) ^ (bits_type(1) << (sizeof(Key) * 8 - 1)));
+			else
+				return static_cast<bits_type>(key);
+		}
+	}
+
+	template<class InIter, class OutIter, class Key>
+	void radix_scatter(InIter start, InIter end, OutIter out, size_t* offsets, unsigned shift, Key& key)
+	{
+		for (; start != end; ++start)
+		{
+			size_t digit = (radix_bits(key(*start)) >> shift) & 0xFF;
+			out[offsets[digit]++] = std::move(*start);
+		}
+	}
+
+	// Stable LSD radix sort on key(element), one byte per pass. A single pre-pass builds every
+	// histogram, and passes in which all elements share the same byte are skipped.
+	template<class Iter, class Key = identity_key>
+	void radix_sort(Iter start, Iter end, Key key = identity_key())
+	{
+		assert(start <= end && "transposed iterator range");
+
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+		using bits_type  = decltype(radix_bits(key(*start)));
+
+		constexpr unsigned passes = sizeof(bits_type);
+		const size_t n = static_cast<size_t>(end - start);
+
+		if (n <= static_cast<size_t>(insertion_sort_threshold))
+		{
+			insertion_sort(start, end, [&key](const value_type& a, const value_type& b) { return radix_bits(key(a)) <= radix_bits(key(b)); });
+			return;
+		}
+
+		std::vector<size_t> counts(passes * 256);
+
+		for (Iter it = start; it != end; ++it)
+		{
+			bits_type bits = radix_bits(key(*it));
+
+			for (unsigned pass = 0; pass < passes; ++pass)
+				counts[pass * 256 + ((bits >> (pass * 8)) & 0xFF)] += 1;
+		}
+
+		std::vector<value_type> buffer;
+		bool in_buffer = false;
+
+		for (unsigned pass = 0; pass < passes; ++pass)
+		{
+			size_t* offsets = counts.data() + pass * 256;
+			size_t first_digit = (radix_bits(key(in_buffer ? buffer.front() : *start)) >> (pass * 8)) & 0xFF;
+
+			if (offsets[first_digit] == n) continue;
+
+			for (size_t digit = 0, sum = 0; digit < 256; ++digit)
+			{
+				size_t count = offsets[digit];
+				offsets[digit] = sum;
+				sum += count;
+			}
+
+			if (buffer.empty()) buffer.resize(n);
+
+			if (in_buffer)
+				radix_scatter(buffer.begin(), buffer.end(), start, offsets, pass * 8, key);
+			else
+				radix_scatter(start, end, buffer.begin(), offsets, pass * 8, key);
+
+			in_buffer = !in_buffer;
+		}
+
+		if (in_buffer)
+			std::move(buffer.begin(), buffer.end(), start);
+	}
+
+	// Byte at depth of a string-like key, shifted by one so that 0 marks the end of the key
+	template<class S>
+	size_t string_digit(const S& s, size_t depth) noexcept
+	{
+		std::string_view view(s);
+		return depth < view.size() ? static_cast<unsigned char>(view[depth]) + size_t(1) : 0;
+	}
+
+	template<class Iter, class BufferIter, class Key>
+	void msd_radix_sort_step(Iter start, size_t n, BufferIter buffer, size_t depth, Key& key)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		for (;;)
+		{
+			if (n <= static_cast<size_t>(insertion_sort_threshold))
+			{
+				insertion_sort(start, start + n, [&key](const value_type& a, const value_type& b)
+				{
+					return std::string_view(key(a)) <= std::string_view(key(b));
+				});
+				return;
+			}
+
+			size_t counts[257] = {};
+
+			for (size_t i = 0; i < n; ++i)
+				counts[string_digit(key(start[i]), depth)] += 1;
+
+			// Every key shares this byte: move on to the next one without scattering
+			size_t first_digit = string_digit(key(start[0]), depth);
+			if (first_digit != 0 && counts[first_digit] == n)
+			{
+				depth += 1;
+				continue;
+			}
+
+			size_t offsets[257];
+			for (size_t digit = 0, sum = 0; digit < 257; ++digit)
+			{
+				offsets[digit] = sum;
+				sum += counts[digit];
+			}
+
+			for (size_t i = 0; i < n; ++i)
+				buffer[offsets[string_digit(key(start[i]), depth)]++] = std::move(start[i]);
+
+			std::move(buffer, buffer + n, start);
+
+			for (size_t digit = 1, offset = counts[0]; digit < 257; offset += counts[digit], ++digit)
+			{
+				if (counts[digit] > 1)
+					msd_radix_sort_step(start + offset, counts[digit], buffer, depth + 1, key);
+			}
+
+			return;
+		}
+	}
+
+	// Stable MSD radix sort for byte-string keys: key(element) must convert to std::string_view,
+	// so fixed-width byte arrays can be sorted through a key returning string_view(data, width)
+	template<class Iter, class Key = identity_key>
+	void msd_radix_sort(Iter start, Iter end, Key key = identity_key())
+	{
+		assert(start <= end && "transposed iterator range");
+
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		size_t n = static_cast<size_t>(end - start);
+		if (n < 2) return;
+
+		std::vector<value_type> buffer(n);
+		msd_radix_sort_step(start, n, buffer.begin(), 0, key);
+	}
+
+	// Moves the elements so that position i receives the element that was at order[i]. Follows
+	// the cycles of the permutation, so every element is moved once through a single temporary.
+	template<class Iter>
+	void apply_permutation(Iter start, std::vector<size_t> order)
+	{
+		using value_type = typename std::iterator_traits<Iter>::value_type;
+
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			if (order[i] == i) continue;
+
+			value_type tmp = std::move(start[i]);
+			size_t hole = i;
+
+			for (;;)
+			{
+				size_t next = order[hole];
+				order[hole] = hole;
+
+				if (next == i)
+				{
+					start[hole] = std::move(tmp);
+					break;
+				}
+
+				start[hole] = std::move(start[next]);
+				hole = next;
+			}
+		}
+	}
+
+	// Positions of the elements in stably sorted order by key(element), leaving the range untouched.
+	// Every key is computed once into a compact array of (key, index) pairs, and only those pairs are
+	// sorted: by radix sort for number keys under less or less_equal, by merge sort otherwise.
+	template<class Iter, class Key = identity_key, class Cmp = std::less_equal<>>
+	[[nodiscard]] std::vector<size_t> argsort(Iter start, Iter end, Key key = identity_key(), Cmp cmp = std::less_equal<>())
+	{
+		assert(start <= end && "transposed iterator range");
+
+		using key_type = std::decay_t<decltype(key(*start))>;
+		using entry    = std::pair<key_type, size_t>;
+
+		const size_t n = static_cast<size_t>(end - start);
+
+		std::vector<entry> entries;
+		entries.reserve(n);
+
+		for (size_t i = 0; i < n; ++i, ++start)
+			entries.emplace_back(key(*start), i);
+
+		constexpr bool radix = std::is_arithmetic<key_type>::value && !std::is_same<key_type, bool>::value
+			&& (std::is_same<Cmp, std::less<>>::value || std::is_same<Cmp, std::less_equal<>>::value
+				|| std::is_same<Cmp, std::less<key_type>>::value || std::is_same<Cmp, std::less_equal<key_type>>::value);
+
+		if constexpr (radix)
+			radix_sort(entries.begin(), entries.end(), [](const entry& e) { return e.first; });
+		else
+			merge_sort(entries.begin(), entries.end(), [&cmp](const entry& a, const entry& b) { return cmp(a.first, b.first); });
+
+		std::vector<size_t> order(n);
+		for (size_t i = 0; i < n; ++i)
+			order[i] = entries[i].second;
+
+		return order;
+	}
+
+	// Stable sort by a derived key that is computed once per element instead of at every
+	// comparison; large elements are moved once each, after the order is known
+	template<class Iter, class Key, class Cmp = std::less_equal<>>
+	void sort_by_key(Iter start, Iter end, Key key, Cmp cmp = std::less_equal<>())
+	{
+		apply_permutation(start, argsort(start, end, key, cmp));
 	}
-}
\ No newline at end of file
+}
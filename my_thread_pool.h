@@ -0,0 +1,248 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ist
+{
+	// Every worker owns a deque: it pushes and pops its own tasks at the back, while idle
+	// workers steal the oldest (and usually largest) tasks from the front of other deques.
+	class WorkStealingPool
+	{
+	public:
+		using task_type = std::function<void()>;
+
+	public:
+		explicit WorkStealingPool(unsigned threads = std::thread::hardware_concurrency())
+			: stop_(false), pending_(0), next_queue_(0)
+		{
+			if (threads == 0) threads = 1;
+
+			for (unsigned i = 0; i < threads; ++i)
+				queues_.push_back(std::make_unique<worker_queue>());
+
+			for (unsigned i = 0; i < threads; ++i)
+				threads_.emplace_back([this, i] { worker_loop(i); });
+		}
+
+		WorkStealingPool(const WorkStealingPool&) = delete;
+		WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+		~WorkStealingPool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(sleep_mutex_);
+				stop_.store(true);
+			}
+
+			sleep_cv_.notify_all();
+
+			for (std::thread& thread : threads_)
+				thread.join();
+		}
+
+		static WorkStealingPool& default_pool()
+		{
+			static WorkStealingPool pool;
+			return pool;
+		}
+
+	public:
+		void submit(task_type task)
+		{
+			worker_slot& slot = current_worker();
+			size_t idx = slot.pool == this ? slot.index : next_queue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+
+			{
+				std::lock_guard<std::mutex> lock(queues_[idx]->mutex);
+				queues_[idx]->tasks.push_back(std::move(task));
+			}
+
+			pending_.fetch_add(1, std::memory_order_release);
+
+			{
+				std::lock_guard<std::mutex> lock(sleep_mutex_);
+			}
+
+			sleep_cv_.notify_one();
+		}
+
+		// Runs one queued task on the calling thread, so a thread waiting for its
+		// children keeps the pool busy instead of blocking a worker
+		bool run_one()
+		{
+			worker_slot& slot = current_worker();
+			size_t home = slot.pool == this ? slot.index : 0;
+
+			task_type task;
+			if (!take(home, task)) return false;
+
+			task();
+			return true;
+		}
+
+		unsigned size() const noexcept
+		{
+			return static_cast<unsigned>(threads_.size());
+		}
+
+	private:
+		struct alignas(64) worker_queue
+		{
+			std::mutex            mutex;
+			std::deque<task_type> tasks;
+		};
+
+		struct worker_slot
+		{
+			WorkStealingPool* pool  = nullptr;
+			size_t            index = 0;
+		};
+
+		static worker_slot& current_worker() noexcept
+		{
+			static thread_local worker_slot slot;
+			return slot;
+		}
+
+		bool take(size_t home, task_type& task)
+		{
+			if (pending_.load(std::memory_order_acquire) == 0) return false;
+
+			{
+				worker_queue& own = *queues_[home];
+				std::lock_guard<std::mutex> lock(own.mutex);
+
+				if (!own.tasks.empty())
+				{
+					task = std::move(own.tasks.back());
+					own.tasks.pop_back();
+					pending_.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+
+			for (size_t i = 1; i < queues_.size(); ++i)
+			{
+				worker_queue& victim = *queues_[(home + i) % queues_.size()];
+				std::lock_guard<std::mutex> lock(victim.mutex);
+
+				if (!victim.tasks.empty())
+				{
+					task = std::move(victim.tasks.front());
+					victim.tasks.pop_front();
+					pending_.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+
+			return false;
+		}
+
+		void worker_loop(size_t index)
+		{
+			worker_slot& slot = current_worker();
+			slot.pool = this;
+			slot.index = index;
+
+			for (;;)
+			{
+				task_type task;
+
+				if (take(index, task))
+				{
+					task();
+					continue;
+				}
+
+				std::unique_lock<std::mutex> lock(sleep_mutex_);
+				sleep_cv_.wait(lock, [this] { return stop_.load() || pending_.load(std::memory_order_acquire) > 0; });
+
+				if (stop_.load() && pending_.load(std::memory_order_acquire) == 0) return;
+			}
+		}
+
+	private:
+		std::vector<std::unique_ptr<worker_queue>> queues_;
+		std::vector<std::thread>                   threads_;
+		std::atomic<bool>                          stop_;
+		std::atomic<size_t>                        pending_;
+		std::atomic<size_t>                        next_queue_;
+		std::mutex                                 sleep_mutex_;
+		std::condition_variable                    sleep_cv_;
+	};
+
+	// Fork-join scope over a WorkStealingPool; wait() helps run tasks until all children finish
+	// and rethrows the first exception any of them raised
+	class TaskGroup
+	{
+	public:
+		explicit TaskGroup(WorkStealingPool& pool) noexcept
+			: pool_(pool), outstanding_(0) {}
+
+		TaskGroup(const TaskGroup&) = delete;
+		TaskGroup& operator=(const TaskGroup&) = delete;
+
+		~TaskGroup()
+		{
+			drain();
+		}
+
+		template<class F>
+		void run(F&& f)
+		{
+			outstanding_.fetch_add(1, std::memory_order_relaxed);
+
+			pool_.submit([this, f = std::forward<F>(f)]() mutable
+			{
+				try
+				{
+					f();
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(error_mutex_);
+					if (!error_) error_ = std::current_exception();
+				}
+
+				outstanding_.fetch_sub(1, std::memory_order_release);
+			});
+		}
+
+		void wait()
+		{
+			drain();
+
+			if (error_)
+			{
+				std::exception_ptr error = std::move(error_);
+				error_ = nullptr;
+				std::rethrow_exception(error);
+			}
+		}
+
+	private:
+		void drain()
+		{
+			while (outstanding_.load(std::memory_order_acquire) != 0)
+			{
+				if (!pool_.run_one())
+					std::this_thread::yield();
+			}
+		}
+
+	private:
+		WorkStealingPool&   pool_;
+		std::atomic<size_t> outstanding_;
+		std::mutex          error_mutex_;
+		std::exception_ptr  error_;
+	};
+}
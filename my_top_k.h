@@ -0,0 +1,132 @@
+#pragma once
+#include "my_sort.h"
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace ist
+{
+	// Keeps the k elements of a stream that come first under cmp, the k smallest by default.
+	// Elements collect in a buffer of 2k; when it fills, nth_element cuts it back to the best k
+	// and the k-th best becomes a threshold that turns most later elements away with a single
+	// comparison. Amortized O(1) per element in 2k elements of memory.
+	template<class T, class Cmp = std::less_equal<>>
+	class TopK
+	{
+	public:
+		explicit TopK(size_t k, Cmp cmp = Cmp())
+			: k_(k), cmp_(cmp), less_{ cmp }, has_threshold_(false)
+		{
+			buffer_.reserve(2 * k_);
+		}
+
+		void push(const T& value)
+		{
+			if (rejects(value)) return;
+
+			buffer_.push_back(value);
+			if (buffer_.size() == 2 * k_) shrink();
+		}
+
+		void push(T&& value)
+		{
+			if (rejects(value)) return;
+
+			buffer_.push_back(std::move(value));
+			if (buffer_.size() == 2 * k_) shrink();
+		}
+
+		template<class Iter>
+		void push(Iter first, Iter last)
+		{
+			for (; first != last; ++first)
+				push(*first);
+		}
+
+		// Folds in a partial result, e.g. one accumulated by another thread
+		void merge(const TopK& other)
+		{
+			push(other.buffer_.begin(), other.buffer_.end());
+		}
+
+		void merge(TopK&& other)
+		{
+			for (T& value : other.buffer_)
+				push(std::move(value));
+
+			other.clear();
+		}
+
+		// The best min(k, pushed) elements in order
+		[[nodiscard]] std::vector<T> sorted() const
+		{
+			std::vector<T> result(buffer_);
+			finish(result);
+
+			return result;
+		}
+
+		// sorted() that moves the elements out and leaves the accumulator empty
+		[[nodiscard]] std::vector<T> take()
+		{
+			std::vector<T> result(std::move(buffer_));
+			clear();
+			finish(result);
+
+			return result;
+		}
+
+		void clear()
+		{
+			buffer_.clear();
+			buffer_.reserve(2 * k_);
+			has_threshold_ = false;
+		}
+
+		[[nodiscard]] size_t size() const noexcept
+		{
+			return std::min(buffer_.size(), k_);
+		}
+
+		[[nodiscard]] size_t capacity() const noexcept
+		{
+			return k_;
+		}
+
+	private:
+		bool rejects(const T& value)
+		{
+			return k_ == 0 || (has_threshold_ && !less_(value, buffer_[k_ - 1]));
+		}
+
+		// Keeps the best k with the k-th best at index k - 1, where rejects() finds it
+		void shrink()
+		{
+			ist::nth_element(buffer_.begin(), buffer_.begin() + (k_ - 1), buffer_.end(), cmp_);
+			buffer_.erase(buffer_.begin() + k_, buffer_.end());
+			less_.probe(buffer_[k_ - 1]);
+			has_threshold_ = true;
+		}
+
+		void finish(std::vector<T>& result) const
+		{
+			if (result.size() > k_)
+			{
+				ist::nth_element(result.begin(), result.begin() + (k_ - 1), result.end(), cmp_);
+				result.erase(result.begin() + k_, result.end());
+			}
+
+			ist::quick_sort(result.begin(), result.end(), cmp_);
+		}
+
+	private:
+		size_t           k_;
+		Cmp              cmp_;
+		StrictOrder<Cmp> less_;
+		bool             has_threshold_;
+		std::vector<T>   buffer_;
+	};
+}
@@ -1,11 +1,137 @@
 #pragma once
-#include "TreeLib.h"
+#include "my_frozen_tree.h"
+#include "my_tree_lib.h"
 
+#include <cassert>
 #include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 
 namespace ist {
-	template<class K, class T>
+	template<class Tree>
+	class ConstTreeIterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using difference_type   = ptrdiff_t;
+
+		using value_type = typename Tree::node;
+		using node_ptr   = typename Tree::node_ptr;
+		using reference  = const value_type&;
+		using pointer    = const value_type*;
+
+		ConstTreeIterator() noexcept : ptr{}, tree{} {}
+
+		explicit ConstTreeIterator(node_ptr ptr, const Tree* tree) noexcept
+			: ptr{ ptr }, tree{ tree } {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return *ptr;
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return ptr;
+		}
+
+		ConstTreeIterator& operator++() noexcept
+		{
+			ptr = TreeLib::successor(ptr);
+			return *this;
+		}
+
+		ConstTreeIterator operator++(int) noexcept
+		{
+			ConstTreeIterator tmp = *this;
+			++* this;
+			return tmp;
+		}
+
+		ConstTreeIterator& operator--() noexcept
+		{
+			ptr = ptr ? TreeLib::predecessor(ptr) : TreeLib::findMax(tree->head_);
+			return *this;
+		}
+
+		ConstTreeIterator operator--(int) noexcept
+		{
+			ConstTreeIterator tmp = *this;
+			--* this;
+			return tmp;
+		}
+
+		[[nodiscard]] bool operator==(const ConstTreeIterator& other) const noexcept
+		{
+			return ptr == other.ptr;
+		}
+
+		[[nodiscard]] bool operator!=(const ConstTreeIterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+		node_ptr    ptr;
+		const Tree* tree;
+	};
+
+	template<class Tree>
+	class TreeIterator : public ConstTreeIterator<Tree>
+	{
+	public:
+		using my_base = ConstTreeIterator<Tree>;
+
+		using value_type = typename Tree::node;
+		using node_ptr   = typename Tree::node_ptr;
+		using reference  = value_type&;
+		using pointer    = value_type*;
+
+		TreeIterator() noexcept {}
+
+		explicit TreeIterator(node_ptr ptr, const Tree* tree) noexcept
+			: my_base(ptr, tree) {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return const_cast<reference>(my_base::operator*());
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return const_cast<pointer>(my_base::operator->());
+		}
+
+		TreeIterator& operator++() noexcept
+		{
+			my_base::operator++();
+			return *this;
+		}
+
+		TreeIterator operator++(int) noexcept
+		{
+			TreeIterator iterator = *this;
+			my_base::operator++();
+			return iterator;
+		}
+
+		TreeIterator& operator--() noexcept
+		{
+			my_base::operator--();
+			return *this;
+		}
+
+		TreeIterator operator--(int) noexcept
+		{
+			TreeIterator iterator = *this;
+			my_base::operator--();
+			return iterator;
+		}
+	};
+
+	template<class K, class T, class Allocator = std::allocator<T>, class Augment = TreeLib::NoAugment>
 	class Tree
 	{
 	public:
@@ -18,20 +144,61 @@ namespace ist {
 		using const_reference = const value_type&;
 		using const_pointer   = const value_type*;
 
-		using node            = TreeLib::Node<K, T>;
+		using allocator_type  = Allocator;
+
+		using node            = TreeLib::Node<K, T, Augment>;
 		using node_ptr        = node*;
 
+		using const_iterator  = ConstTreeIterator<Tree>;
+		using iterator        = TreeIterator<Tree>;
+
+		friend const_iterator;
+
+	protected:
+		using Alloc		   = typename std::allocator_traits<Allocator>::template rebind_alloc<node>;
+		using Alloc_traits = std::allocator_traits<Alloc>;
+
 	public:
 		Tree()
-			: head_(nullptr), size_(0) {}
+			: head_(nullptr), size_(0), alloc_() {}
+
+		explicit Tree(const allocator_type& alloc)
+			: head_(nullptr), size_(0), alloc_(alloc) {}
 
 		Tree(const Tree& other)
-			: head_(nullptr), size_(0)
+			: head_(nullptr), size_(other.size_), alloc_(Alloc_traits::select_on_container_copy_construction(other.alloc_))
+		{
+			head_ = TreeLib::clone(alloc_, other.head_);
+		}
+
+		// The allocator is copied, not moved, so the moved-from tree keeps a usable one without
+		// allocating; sharing an arena is safe since clear() releases it only when sole owner
+		Tree(Tree&& other) noexcept
+			: head_(other.head_), size_(other.size_), alloc_(other.alloc_)
 		{
-			other.for_each([this](node_ptr node)
-				{
-					this->emplace(node->key, node->value);
-				});
+			other.head_ = nullptr;
+			other.size_ = 0;
+		}
+
+		Tree& operator=(Tree other) noexcept
+		{
+			std::swap(head_, other.head_);
+			std::swap(size_, other.size_);
+			std::swap(alloc_, other.alloc_);
+			return *this;
+		}
+
+		// [first, last) must yield (key, value) pairs in ascending key order
+		template<class Iter>
+		static Tree from_sorted(Iter first, Iter last)
+		{
+			Tree tree;
+			size_t n = static_cast<size_t>(std::distance(first, last));
+
+			tree.head_ = TreeLib::buildSorted<K, T, Augment>(tree.alloc_, first, n);
+			tree.size_ = n;
+
+			return tree;
 		}
 
 		~Tree()
@@ -39,23 +206,167 @@ namespace ist {
 			clear();
 		}
 
-		template<class K, class... Args>
-		node_ptr emplace(K&& key, Args&&... args)
+		template<class Key, class... Args>
+		node_ptr emplace(Key&& key, Args&&... args)
 		{
 			size_ += 1;
-			return TreeLib::emplace(head_, std::forward<K>(key), std::forward<Args>(args)...);
+			return TreeLib::emplace(alloc_, head_, key_type(std::forward<Key>(key)), std::forward<Args>(args)...);
 		}
 
-		void erase(const key_type& key)
+		// Removes one node holding key; false if there is none
+		bool erase(const key_type& key)
 		{
-			size_ -= 1;
-			head_ = TreeLib::remove(head_, key);
+			size_t removed = 0;
+
+			head_ = TreeLib::remove(alloc_, head_, key, removed);
+			if (head_) head_->parent = nullptr;
+			size_ -= removed;
+
+			return removed != 0;
+		}
+
+		// The set operations adopt other's nodes and leave it empty; both trees must share
+		// an allocator and hold unique keys. threads > 1 merges disjoint subtrees concurrently
+		// when the allocator is thread-safe, and is ignored otherwise.
+		void merge_union(Tree& other, unsigned threads = 1)
+		{
+			size_t dropped = 0;
+			size_t total = size_ + other.size_;
+
+			head_ = TreeLib::unite(alloc_, head_, other.adopt(alloc_), dropped, fork_depth(threads));
+			size_ = total - dropped;
+		}
+
+		void intersect_with(Tree& other, unsigned threads = 1)
+		{
+			size_t kept = 0;
+
+			head_ = TreeLib::intersect(alloc_, head_, other.adopt(alloc_), kept, fork_depth(threads));
+			size_ = kept;
+		}
+
+		void subtract(Tree& other, unsigned threads = 1)
+		{
+			size_t removed = 0;
+
+			head_ = TreeLib::difference(alloc_, head_, other.adopt(alloc_), removed, fork_depth(threads));
+			size_ -= removed;
+		}
+
+		// pred is called with a const node& and may run on several threads at once
+		template<class Pred>
+		size_t erase_if(Pred pred, unsigned threads = 1)
+		{
+			size_t removed = 0;
+			auto keep = [&pred](const node& n) { return !pred(n); };
+
+			head_ = TreeLib::filter(alloc_, head_, keep, removed, fork_depth(threads));
+			size_ -= removed;
+
+			return removed;
 		}
 
 		void clear()
 		{
-			TreeLib::removeAll(head_);
+			if (!head_) return;
+
+			// An arena hands back whole slabs when no node needs its destructor run, but only
+			// if no other tree or allocator copy shares it and still owns nodes in it
+			if constexpr (TreeLib::canRelease<Alloc>::value && std::is_trivially_destructible<node>::value)
+			{
+				if (alloc_.use_count() == 1)
+					alloc_.release();
+				else
+					TreeLib::removeAll(alloc_, head_);
+			}
+			else
+			{
+				TreeLib::removeAll(alloc_, head_);
+			}
+
 			head_ = nullptr;
+			size_ = 0;
+		}
+
+		// Copies the keys into a read-only Eytzinger layout for lookup-heavy phases
+		[[nodiscard]] FrozenTree<K, T> freeze() const
+		{
+			return FrozenTree<K, T>(cbegin(), size_);
+		}
+
+		allocator_type get_allocator() const noexcept
+		{
+			return allocator_type(alloc_);
+		}
+
+		[[nodiscard]] iterator find(const key_type& key) noexcept
+		{
+			return iterator{ TreeLib::find(head_, key), this };
+		}
+
+		[[nodiscard]] const_iterator find(const key_type& key) const noexcept
+		{
+			return const_iterator{ TreeLib::find(head_, key), this };
+		}
+
+		[[nodiscard]] bool contains(const key_type& key) const noexcept
+		{
+			return TreeLib::find(head_, key) != nullptr;
+		}
+
+		[[nodiscard]] iterator lower_bound(const key_type& key) noexcept
+		{
+			return iterator{ TreeLib::lowerBound(head_, key), this };
+		}
+
+		[[nodiscard]] const_iterator lower_bound(const key_type& key) const noexcept
+		{
+			return const_iterator{ TreeLib::lowerBound(head_, key), this };
+		}
+
+		[[nodiscard]] iterator upper_bound(const key_type& key) noexcept
+		{
+			return iterator{ TreeLib::upperBound(head_, key), this };
+		}
+
+		[[nodiscard]] const_iterator upper_bound(const key_type& key) const noexcept
+		{
+			return const_iterator{ TreeLib::upperBound(head_, key), this };
+		}
+
+		[[nodiscard]] std::pair<iterator, iterator> equal_range(const key_type& key) noexcept
+		{
+			return { lower_bound(key), upper_bound(key) };
+		}
+
+		[[nodiscard]] std::pair<const_iterator, const_iterator> equal_range(const key_type& key) const noexcept
+		{
+			return { lower_bound(key), upper_bound(key) };
+		}
+
+		// Order statistics need Augment = TreeLib::SizeAugment, see OrderStatisticTree
+		[[nodiscard]] iterator select(size_t k) noexcept
+		{
+			return iterator{ TreeLib::select(head_, k), this };
+		}
+
+		[[nodiscard]] const_iterator select(size_t k) const noexcept
+		{
+			return const_iterator{ TreeLib::select(head_, k), this };
+		}
+
+		[[nodiscard]] size_t rank(const key_type& key) const noexcept
+		{
+			return TreeLib::rank(head_, key);
+		}
+
+		// Number of keys in [lo, hi)
+		[[nodiscard]] size_t count_range(const key_type& lo, const key_type& hi) const noexcept
+		{
+			size_t below_hi = TreeLib::rank(head_, hi);
+			size_t below_lo = TreeLib::rank(head_, lo);
+
+			return below_hi > below_lo ? below_hi - below_lo : 0;
 		}
 
 		size_t size() const
@@ -74,6 +385,32 @@ namespace ist {
 		}
 
 	private:
+		node_ptr adopt(const Alloc& alloc) noexcept
+		{
+			assert(alloc == alloc_ && "set operations need trees that share an allocator");
+			(void)alloc;
+
+			node_ptr p = head_;
+			head_ = nullptr;
+			size_ = 0;
+
+			return p;
+		}
+
+		// Nodes are created and destroyed on every worker, so an allocator that is not
+		// thread-safe keeps the set operations on the calling thread
+		static int fork_depth(unsigned threads) noexcept
+		{
+			int depth = 0;
+
+			if constexpr (TreeLib::isThreadSafe<Alloc>::value)
+				while ((1u << depth) < threads) ++depth;
+			else
+				(void)threads;
+
+			return depth;
+		}
+
 		void postOrder(std::function<void(node_ptr)> f, node_ptr node)
 		{
 			if (node == nullptr) return;
@@ -90,9 +427,43 @@ namespace ist {
 			f(node);
 		}
 
-	private:
+	public:
+		[[nodiscard]] iterator begin() noexcept
+		{
+			return iterator{ head_ ? TreeLib::findMin(head_) : nullptr, this };
+		}
+
+		[[nodiscard]] const_iterator cbegin() const noexcept
+		{
+			return const_iterator{ head_ ? TreeLib::findMin(head_) : nullptr, this };
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return iterator{ nullptr, this };
+		}
+
+		[[nodiscard]] const_iterator cend() const noexcept
+		{
+			return const_iterator{ nullptr, this };
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return cbegin();
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return cend();
+		}
+
+	protected:
 		node_ptr head_;
 		size_t   size_;
+		Alloc    alloc_;
 	};
 
+	template<class K, class T, class Allocator = std::allocator<T>>
+	using OrderStatisticTree = Tree<K, T, Allocator, TreeLib::SizeAugment>;
 }
@@ -1,51 +1,155 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 namespace TreeLib
 {
-	template<class K, class T>
-	struct Node
+	struct NoAugment
+	{
+		template<class N>
+		static void update(N*) noexcept {}
+	};
+
+	struct SizeAugment
+	{
+		size_t size = 1;
+
+		template<class N>
+		static void update(N* p) noexcept
+		{
+			p->size = 1 + (p->left ? p->left->size : 0) + (p->right ? p->right->size : 0);
+		}
+	};
+
+	// Keeps the largest key.hi of the subtree, for keys shaped like an interval
+	template<class E>
+	struct MaxEndAugment
+	{
+		E maxEnd{};
+
+		template<class N>
+		static void update(N* p)
+		{
+			p->maxEnd = p->key.hi;
+			if (p->left && p->maxEnd < p->left->maxEnd) p->maxEnd = p->left->maxEnd;
+			if (p->right && p->maxEnd < p->right->maxEnd) p->maxEnd = p->right->maxEnd;
+		}
+	};
+
+	template<class K, class T, class Aug = NoAugment>
+	struct Node : Aug
 	{
 		template<class... Args>
 		explicit Node(K&& key, Args&&... args)
-			: key(std::forward<K>(key)), value(std::forward<Args>(args)...), height(1), left(nullptr), right(nullptr) {}
-
-		K key;
-		T value;
-		
-		size_t height;
+			: left(nullptr), right(nullptr), parent(nullptr), key(std::forward<K>(key)), height(1), value(std::forward<Args>(args)...) {}
 
 		Node* left;
 		Node* right;
+		Node* parent;
+
+		K key;
+		std::uint8_t height;
+		T value;
 	};
+
+	template<class Alloc, class = void>
+	struct canRelease : std::false_type {};
+
+	// Arena allocators that can free every node at once and tell whether anyone else shares the arena
+	template<class Alloc>
+	struct canRelease<Alloc, std::void_t<decltype(std::declval<Alloc&>().release()), decltype(std::declval<const Alloc&>().use_count())>> : std::true_type {};
+
+	// Allocators several threads may allocate from and free to at once: std::allocator and
+	// any allocator that declares is_thread_safe as std::true_type
+	template<class Alloc, class = void>
+	struct isThreadSafe : std::false_type {};
+
+	template<class U>
+	struct isThreadSafe<std::allocator<U>> : std::true_type {};
+
+	template<class Alloc>
+	struct isThreadSafe<Alloc, std::void_t<typename Alloc::is_thread_safe>> : Alloc::is_thread_safe {};
+
+	template<class Alloc, class... Args>
+	typename std::allocator_traits<Alloc>::value_type* createNode(Alloc& alloc, Args&&... args)
+	{
+		using traits = std::allocator_traits<Alloc>;
+
+		auto* p = traits::allocate(alloc, 1);
+
+		try
+		{
+			traits::construct(alloc, p, std::forward<Args>(args)...);
+		}
+		catch (...)
+		{
+			traits::deallocate(alloc, p, 1);
+			throw;
+		}
+
+		return p;
+	}
+
+	template<class Alloc, class K, class T, class Aug>
+	void destroyNode(Alloc& alloc, Node<K, T, Aug>* p)
+	{
+		std::allocator_traits<Alloc>::destroy(alloc, p);
+		std::allocator_traits<Alloc>::deallocate(alloc, p, 1);
+	}
+
+	template<class K, class T, class Aug>
+	void setLeft(Node<K, T, Aug>* p, Node<K, T, Aug>* child)
+	{
+		p->left = child;
+		if (child) child->parent = p;
+	}
+
+	template<class K, class T, class Aug>
+	void setRight(Node<K, T, Aug>* p, Node<K, T, Aug>* child)
+	{
+		p->right = child;
+		if (child) child->parent = p;
+	}
 	
-	template<class K, class T>
-	size_t height(Node<K, T>* p)
+	// The height helpers only need left, right and height, so other AVL node layouts share them
+	template<class N>
+	int height(const N* p)
 	{
 		return p ? p->height : 0;
 	}
 
-	template<class K, class T>
-	int bFactor(Node<K, T>* p)
+	template<class N>
+	int bFactor(const N* p)
 	{
 		return height(p->right) - height(p->left);
 	}
 
-	template<class K, class T>
-	void fixHeight(Node<K, T>* p)
+	template<class N>
+	void updateHeight(N* p)
 	{
-		size_t hl = height(p->left);
-		size_t hr = height(p->right);
+		int hl = height(p->left);
+		int hr = height(p->right);
+
+		p->height = static_cast<std::uint8_t>((hl > hr ? hl : hr) + 1);
+	}
 
-		p->height = (hl > hr ? hl : hr) + 1;
+	template<class K, class T, class Aug>
+	void fixHeight(Node<K, T, Aug>* p)
+	{
+		updateHeight(p);
+		Aug::update(p);
 	}
 
-	template<class K, class T>
-	Node<K, T>* rotateRight(Node<K, T>* p)
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* rotateRight(Node<K, T, Aug>* p)
 	{
-		Node<K, T>* q = p->left;
-		p->left = q->right;
-		q->right = p;
+		Node<K, T, Aug>* q = p->left;
+		setLeft(p, q->right);
+		setRight(q, p);
 
 		fixHeight(p);
 		fixHeight(q);
@@ -53,12 +157,12 @@ namespace TreeLib
 		return q;
 	}
 
-	template<class K, class T>
-	Node<K, T>* rotateLeft(Node<K, T>* q)
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* rotateLeft(Node<K, T, Aug>* q)
 	{
-		Node<K, T>* p = q->right;
-		q->right = p->left;
-		p->left = q;
+		Node<K, T, Aug>* p = q->right;
+		setRight(q, p->left);
+		setLeft(p, q);
 
 		fixHeight(q);
 		fixHeight(p);
@@ -66,15 +170,15 @@ namespace TreeLib
 		return p;
 	}
 
-	template<class K, class T>
-	Node<K, T>* balance(Node<K, T>* p)
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* balance(Node<K, T, Aug>* p)
 	{
 		fixHeight(p);
 
 		if (bFactor(p) == 2)
 		{
 			if (bFactor(p->right) < 0)
-				p->right = rotateRight(p->right);
+				setRight(p, rotateRight(p->right));
 
 			return rotateLeft(p);
 		}
@@ -82,7 +186,7 @@ namespace TreeLib
 		if (bFactor(p) == -2)
 		{
 			if (bFactor(p->left) > 0)
-				p->left = rotateLeft(p->left);
+				setLeft(p, rotateLeft(p->left));
 
 			return rotateRight(p);
 		}
@@ -90,76 +194,259 @@ namespace TreeLib
 		return p;
 	}
 
-	template<class K, class T>
-	Node<K, T>* emplaceHelper(Node<K, T>* p, K&& key, T&& value, Node<K, T>*& to_return)
+	template<class Alloc, class K, class T, class Aug>
+	Node<K, T, Aug>* emplaceHelper(Alloc& alloc, Node<K, T, Aug>* p, K&& key, T&& value, Node<K, T, Aug>*& to_return)
 	{
 		if (!p)
-			return to_return = new Node<K, T>(std::forward<K>(key), std::forward<T>(value));
+		{
+			to_return = createNode(alloc, std::forward<K>(key), std::forward<T>(value));
+			fixHeight(to_return);
+			return to_return;
+		}
 			
 		if (key < p->key)
 		{
-			p->left = emplaceHelper(p->left, std::forward<K>(key), std::forward<T>(value), to_return);
+			setLeft(p, emplaceHelper(alloc, p->left, std::forward<K>(key), std::forward<T>(value), to_return));
 		}
 		else
 		{
-			p->right = emplaceHelper(p->right, std::forward<K>(key), std::forward<T>(value), to_return);
+			setRight(p, emplaceHelper(alloc, p->right, std::forward<K>(key), std::forward<T>(value), to_return));
 		}
 
 		return balance(p);
 	}
 	
-	template<class K, class T, class... Args>
-	Node<K, T>* emplace(Node<K, T>*& p, K&& key, Args&&... args)
+	template<class Alloc, class K, class T, class Aug, class... Args>
+	Node<K, T, Aug>* emplace(Alloc& alloc, Node<K, T, Aug>*& p, K&& key, Args&&... args)
 	{
 		T value{ std::forward<Args>(args)... };
 
-		Node<K, T>* to_return = nullptr;
-		p = emplaceHelper(p, std::forward<K>(key), std::forward<T>(value), to_return);
+		Node<K, T, Aug>* to_return = nullptr;
+		p = emplaceHelper(alloc, p, std::forward<K>(key), std::forward<T>(value), to_return);
+		p->parent = nullptr;
 
 		return to_return;
 	}
 	
-	template<class K, class T>
-	Node<K, T>* findMin(Node<K, T>* p)
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* findMin(Node<K, T, Aug>* p)
+	{
+		while (p->left) p = p->left;
+		return p;
+	}
+
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* findMax(Node<K, T, Aug>* p)
+	{
+		while (p->right) p = p->right;
+		return p;
+	}
+
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* successor(Node<K, T, Aug>* p)
 	{
-		return p->left ? findMin(p->left) : p;
+		if (p->right)
+			return findMin(p->right);
+
+		while (p->parent && p == p->parent->right)
+			p = p->parent;
+
+		return p->parent;
 	}
 
-	template<class K, class T>
-	Node<K, T>* removeMin(Node<K, T>* p)
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* predecessor(Node<K, T, Aug>* p)
+	{
+		if (p->left)
+			return findMax(p->left);
+
+		while (p->parent && p == p->parent->left)
+			p = p->parent;
+
+		return p->parent;
+	}
+
+	template<class K, class T, class Aug, class Key>
+	Node<K, T, Aug>* find(Node<K, T, Aug>* p, const Key& key)
+	{
+		while (p)
+		{
+			if (key < p->key)
+				p = p->left;
+			else if (p->key < key)
+				p = p->right;
+			else
+				return p;
+		}
+
+		return nullptr;
+	}
+
+	template<class K, class T, class Aug, class Key>
+	Node<K, T, Aug>* lowerBound(Node<K, T, Aug>* p, const Key& key)
+	{
+		Node<K, T, Aug>* result = nullptr;
+
+		while (p)
+		{
+			if (p->key < key)
+			{
+				p = p->right;
+			}
+			else
+			{
+				result = p;
+				p = p->left;
+			}
+		}
+
+		return result;
+	}
+
+	template<class K, class T, class Aug, class Key>
+	Node<K, T, Aug>* upperBound(Node<K, T, Aug>* p, const Key& key)
+	{
+		Node<K, T, Aug>* result = nullptr;
+
+		while (p)
+		{
+			if (key < p->key)
+			{
+				result = p;
+				p = p->left;
+			}
+			else
+			{
+				p = p->right;
+			}
+		}
+
+		return result;
+	}
+
+	template<class K, class T, class Aug>
+	size_t subtreeSize(const Node<K, T, Aug>* p)
+	{
+		return p ? p->size : 0;
+	}
+
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* select(Node<K, T, Aug>* p, size_t k)
+	{
+		while (p)
+		{
+			size_t leftSize = subtreeSize(p->left);
+
+			if (k < leftSize)
+			{
+				p = p->left;
+			}
+			else if (k == leftSize)
+			{
+				return p;
+			}
+			else
+			{
+				k -= leftSize + 1;
+				p = p->right;
+			}
+		}
+
+		return nullptr;
+	}
+
+	template<class K, class T, class Aug, class Key>
+	size_t rank(const Node<K, T, Aug>* p, const Key& key)
+	{
+		size_t result = 0;
+
+		while (p)
+		{
+			if (p->key < key)
+			{
+				result += subtreeSize(p->left) + 1;
+				p = p->right;
+			}
+			else
+			{
+				p = p->left;
+			}
+		}
+
+		return result;
+	}
+
+	// Calls f for every node whose [key.lo, key.hi] overlaps [lo, hi]; needs MaxEndAugment
+	template<class K, class T, class Aug, class E, class F>
+	void forEachOverlap(const Node<K, T, Aug>* p, const E& lo, const E& hi, F& f)
+	{
+		while (p && !(p->maxEnd < lo))
+		{
+			forEachOverlap(p->left, lo, hi, f);
+
+			if (hi < p->key.lo) return;
+			if (!(p->key.hi < lo)) f(*p);
+
+			p = p->right;
+		}
+	}
+
+	// Any node overlapping [lo, hi] in O(log n): if the left subtree reaches lo, either it
+	// holds an overlap or every interval to the right starts after hi
+	template<class K, class T, class Aug, class E>
+	Node<K, T, Aug>* anyOverlap(Node<K, T, Aug>* p, const E& lo, const E& hi)
+	{
+		while (p)
+		{
+			if (!(hi < p->key.lo) && !(p->key.hi < lo))
+				return p;
+
+			if (p->left && !(p->left->maxEnd < lo))
+				p = p->left;
+			else
+				p = p->right;
+		}
+
+		return nullptr;
+	}
+
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* removeMin(Node<K, T, Aug>* p)
 	{
 		if (p->left == 0)
 			return p->right;
 
-		p->left = removeMin(p->left);
+		setLeft(p, removeMin(p->left));
 
 		return balance(p);
 	}
 
-	template<class K, class T>
-	Node<K, T>* remove(Node<K, T>* p, const K& key)
+	// removed counts the node destroyed, if any holds key
+	template<class Alloc, class K, class T, class Aug>
+	Node<K, T, Aug>* remove(Alloc& alloc, Node<K, T, Aug>* p, const K& key, size_t& removed)
 	{
 		if (!p) return nullptr;
 
 		if (key < p->key)
 		{
-			p->left = remove(p->left, key);
+			setLeft(p, remove(alloc, p->left, key, removed));
 		}
 		else if (key > p->key)
 		{
-			p->right = remove(p->right, key);
+			setRight(p, remove(alloc, p->right, key, removed));
 		}
 		else
 		{
-			Node<K, T>* q = p->left;
-			Node<K, T>* r = p->right;
-			delete p;
+			Node<K, T, Aug>* q = p->left;
+			Node<K, T, Aug>* r = p->right;
+			destroyNode(alloc, p);
+			removed += 1;
 
 			if (!r) return q;
 
-			Node<K, T>* min = findMin(r);
-			min->right      = removeMin(r);
-			min->left       = q;
+			Node<K, T, Aug>* min = findMin(r);
+			setRight(min, removeMin(r));
+			setLeft(min, q);
 
 			return balance(min);
 		}
@@ -167,15 +454,341 @@ namespace TreeLib
 		return balance(p);
 	}
 
-	template<class K, class T>
-	void removeAll(Node<K, T>* ptr)
+	template<class Alloc, class K, class T, class Aug>
+	void removeAll(Alloc& alloc, Node<K, T, Aug>* ptr)
 	{
 		if (!ptr) return;
 
-		if (ptr->left)  removeAll(ptr->left);
-		if (ptr->right) removeAll(ptr->right);
+		if (ptr->left)  removeAll(alloc, ptr->left);
+		if (ptr->right) removeAll(alloc, ptr->right);
 
-		delete ptr;
+		destroyNode(alloc, ptr);
 	}
 
-}
+	template<class Alloc, class K, class T, class Aug>
+	Node<K, T, Aug>* clone(Alloc& alloc, const Node<K, T, Aug>* p)
+	{
+		if (!p) return nullptr;
+
+		Node<K, T, Aug>* q = createNode(alloc, K(p->key), p->value);
+
+		try
+		{
+			setLeft(q, clone(alloc, p->left));
+			setRight(q, clone(alloc, p->right));
+		}
+		catch (...)
+		{
+			removeAll(alloc, q);
+			throw;
+		}
+
+		fixHeight(q);
+		return q;
+	}
+
+	// Consumes n (key, value) pairs from an ascending sequence and returns a perfectly balanced subtree
+	template<class K, class T, class Aug, class Alloc, class Iter>
+	Node<K, T, Aug>* buildSorted(Alloc& alloc, Iter& it, size_t n)
+	{
+		if (n == 0) return nullptr;
+
+		size_t leftSize = n / 2;
+		Node<K, T, Aug>* left = buildSorted<K, T, Aug>(alloc, it, leftSize);
+		Node<K, T, Aug>* p = nullptr;
+
+		try
+		{
+			const auto& entry = *it;
+			p = createNode(alloc, K(entry.first), entry.second);
+		}
+		catch (...)
+		{
+			removeAll(alloc, left);
+			throw;
+		}
+
+		++it;
+		setLeft(p, left);
+
+		try
+		{
+			setRight(p, buildSorted<K, T, Aug>(alloc, it, n - leftSize - 1));
+		}
+		catch (...)
+		{
+			removeAll(alloc, p);
+			throw;
+		}
+
+		fixHeight(p);
+		return p;
+	}
+
+	// Links l < k < r into one tree; k must be a detached node
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* joinRight(Node<K, T, Aug>* l, Node<K, T, Aug>* k, Node<K, T, Aug>* r)
+	{
+		if (height(l->right) <= height(r) + 1)
+		{
+			setLeft(k, l->right);
+			setRight(k, r);
+			fixHeight(k);
+			setRight(l, k);
+		}
+		else
+		{
+			setRight(l, joinRight(l->right, k, r));
+		}
+
+		return balance(l);
+	}
+
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* joinLeft(Node<K, T, Aug>* l, Node<K, T, Aug>* k, Node<K, T, Aug>* r)
+	{
+		if (height(r->left) <= height(l) + 1)
+		{
+			setLeft(k, l);
+			setRight(k, r->left);
+			fixHeight(k);
+			setLeft(r, k);
+		}
+		else
+		{
+			setLeft(r, joinLeft(l, k, r->left));
+		}
+
+		return balance(r);
+	}
+
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* join(Node<K, T, Aug>* l, Node<K, T, Aug>* k, Node<K, T, Aug>* r)
+	{
+		Node<K, T, Aug>* p;
+
+		if (height(l) > height(r) + 1)
+		{
+			p = joinRight(l, k, r);
+		}
+		else if (height(r) > height(l) + 1)
+		{
+			p = joinLeft(l, k, r);
+		}
+		else
+		{
+			setLeft(k, l);
+			setRight(k, r);
+			fixHeight(k);
+			p = k;
+		}
+
+		p->parent = nullptr;
+		return p;
+	}
+
+	// Joins l < r without a middle key by borrowing the minimum of r
+	template<class K, class T, class Aug>
+	Node<K, T, Aug>* join2(Node<K, T, Aug>* l, Node<K, T, Aug>* r)
+	{
+		if (!l) { if (r) r->parent = nullptr; return r; }
+		if (!r) { l->parent = nullptr; return l; }
+
+		Node<K, T, Aug>* min = findMin(r);
+		r = removeMin(r);
+
+		return join(l, min, r);
+	}
+
+	// Splits p into keys < key and keys > key; mid receives the node equal to key, if any
+	template<class K, class T, class Aug, class Key>
+	void split(Node<K, T, Aug>* p, const Key& key, Node<K, T, Aug>*& l, Node<K, T, Aug>*& mid, Node<K, T, Aug>*& r)
+	{
+		if (!p)
+		{
+			l = mid = r = nullptr;
+			return;
+		}
+
+		Node<K, T, Aug>* pl = p->left;
+		Node<K, T, Aug>* pr = p->right;
+		if (pl) pl->parent = nullptr;
+		if (pr) pr->parent = nullptr;
+
+		if (key < p->key)
+		{
+			Node<K, T, Aug>* rl;
+			split(pl, key, l, mid, rl);
+			r = join(rl, p, pr);
+		}
+		else if (p->key < key)
+		{
+			Node<K, T, Aug>* lr;
+			split(pr, key, lr, mid, r);
+			l = join(pl, p, lr);
+		}
+		else
+		{
+			l = pl;
+			r = pr;
+			mid = p;
+			mid->left = mid->right = mid->parent = nullptr;
+			fixHeight(mid);
+		}
+	}
+
+	// Subtrees shorter than this are merged on the calling thread
+	static constexpr int parallelGrainHeight = 12;
+
+	template<class Left, class Right>
+	void forkJoin(int depth, int h, Left&& left, Right&& right)
+	{
+		if (depth > 0 && h >= parallelGrainHeight)
+		{
+			auto future = std::async(std::launch::async, std::forward<Left>(left));
+			right();
+			future.get();
+		}
+		else
+		{
+			left();
+			right();
+		}
+	}
+
+	// The set operations consume both trees and treat keys as unique. Up to 2^depth threads
+	// work on disjoint subtrees, so a non-zero depth needs an allocator for which isThreadSafe holds.
+
+	// a's node wins on equal keys; dropped counts the duplicates destroyed from b
+	template<class Alloc, class K, class T, class Aug>
+	Node<K, T, Aug>* unite(Alloc& alloc, Node<K, T, Aug>* a, Node<K, T, Aug>* b, size_t& dropped, int depth = 0)
+	{
+		if (!a) { if (b) b->parent = nullptr; return b; }
+		if (!b) { a->parent = nullptr; return a; }
+
+		Node<K, T, Aug>* bl = b->left;
+		Node<K, T, Aug>* br = b->right;
+		if (bl) bl->parent = nullptr;
+		if (br) br->parent = nullptr;
+
+		Node<K, T, Aug>* l;
+		Node<K, T, Aug>* m;
+		Node<K, T, Aug>* r;
+		split(a, b->key, l, m, r);
+
+		if (m)
+		{
+			destroyNode(alloc, b);
+			dropped += 1;
+		}
+		else
+		{
+			m = b;
+			m->left = m->right = m->parent = nullptr;
+		}
+
+		size_t droppedRight = 0;
+		forkJoin(depth, height(bl) + height(br),
+			[&] { l = unite(alloc, l, bl, dropped, depth - 1); },
+			[&] { r = unite(alloc, r, br, droppedRight, depth - 1); });
+
+		dropped += droppedRight;
+		return join(l, m, r);
+	}
+
+	// Keeps a's nodes whose key is also in b; kept counts them
+	template<class Alloc, class K, class T, class Aug>
+	Node<K, T, Aug>* intersect(Alloc& alloc, Node<K, T, Aug>* a, Node<K, T, Aug>* b, size_t& kept, int depth = 0)
+	{
+		if (!a || !b)
+		{
+			removeAll(alloc, a);
+			removeAll(alloc, b);
+			return nullptr;
+		}
+
+		Node<K, T, Aug>* bl = b->left;
+		Node<K, T, Aug>* br = b->right;
+		if (bl) bl->parent = nullptr;
+		if (br) br->parent = nullptr;
+
+		Node<K, T, Aug>* l;
+		Node<K, T, Aug>* m;
+		Node<K, T, Aug>* r;
+		split(a, b->key, l, m, r);
+		destroyNode(alloc, b);
+
+		size_t keptRight = 0;
+		forkJoin(depth, height(bl) + height(br),
+			[&] { l = intersect(alloc, l, bl, kept, depth - 1); },
+			[&] { r = intersect(alloc, r, br, keptRight, depth - 1); });
+
+		kept += keptRight;
+
+		if (!m) return join2(l, r);
+
+		kept += 1;
+		return join(l, m, r);
+	}
+
+	// Removes from a every key present in b; removed counts the nodes destroyed from a
+	template<class Alloc, class K, class T, class Aug>
+	Node<K, T, Aug>* difference(Alloc& alloc, Node<K, T, Aug>* a, Node<K, T, Aug>* b, size_t& removed, int depth = 0)
+	{
+		if (!a || !b)
+		{
+			removeAll(alloc, b);
+			if (a) a->parent = nullptr;
+			return a;
+		}
+
+		Node<K, T, Aug>* bl = b->left;
+		Node<K, T, Aug>* br = b->right;
+		if (bl) bl->parent = nullptr;
+		if (br) br->parent = nullptr;
+
+		Node<K, T, Aug>* l;
+		Node<K, T, Aug>* m;
+		Node<K, T, Aug>* r;
+		split(a, b->key, l, m, r);
+		destroyNode(alloc, b);
+
+		if (m)
+		{
+			destroyNode(alloc, m);
+			removed += 1;
+		}
+
+		size_t removedRight = 0;
+		forkJoin(depth, height(bl) + height(br),
+			[&] { l = difference(alloc, l, bl, removed, depth - 1); },
+			[&] { r = difference(alloc, r, br, removedRight, depth - 1); });
+
+		removed += removedRight;
+		return join2(l, r);
+	}
+
+	// Keeps the nodes for which pred(node) holds; removed counts the rest
+	template<class Alloc, class K, class T, class Aug, class Pred>
+	Node<K, T, Aug>* filter(Alloc& alloc, Node<K, T, Aug>* p, Pred& pred, size_t& removed, int depth = 0)
+	{
+		if (!p) return nullptr;
+
+		Node<K, T, Aug>* l = p->left;
+		Node<K, T, Aug>* r = p->right;
+
+		size_t removedRight = 0;
+		forkJoin(depth, height(p),
+			[&] { l = filter(alloc, l, pred, removed, depth - 1); },
+			[&] { r = filter(alloc, r, pred, removedRight, depth - 1); });
+
+		removed += removedRight;
+
+		if (pred(static_cast<const Node<K, T, Aug>&>(*p)))
+			return join(l, p, r);
+
+		destroyNode(alloc, p);
+		removed += 1;
+		return join2(l, r);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,526 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace ist
+{
+	template<class List>
+	class ConstUnrolledListIterator
+	{
+	public:
+		using iterator_category = std::bidirectional_iterator_tag;
+		using difference_type   = ptrdiff_t;
+
+		using value_type = typename List::value_type;
+		using base_ptr   = typename List::base_ptr;
+		using node_ptr   = typename List::node_ptr;
+		using reference  = const value_type&;
+		using pointer    = const value_type*;
+
+		ConstUnrolledListIterator() noexcept : ptr{}, idx{} {}
+
+		explicit ConstUnrolledListIterator(base_ptr ptr, size_t idx = 0) noexcept
+			: ptr{ ptr }, idx{ idx } {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return *operator->();
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return static_cast<node_ptr>(ptr)->data() + idx;
+		}
+
+		ConstUnrolledListIterator& operator++() noexcept
+		{
+			if (++idx == static_cast<node_ptr>(ptr)->count)
+			{
+				ptr = ptr->next;
+				idx = 0;
+			}
+
+			return *this;
+		}
+
+		ConstUnrolledListIterator operator++(int) noexcept
+		{
+			ConstUnrolledListIterator tmp = *this;
+			++* this;
+			return tmp;
+		}
+
+		ConstUnrolledListIterator& operator--() noexcept
+		{
+			if (idx == 0)
+			{
+				ptr = ptr->prev;
+				idx = static_cast<node_ptr>(ptr)->count;
+			}
+
+			--idx;
+			return *this;
+		}
+
+		ConstUnrolledListIterator operator--(int) noexcept
+		{
+			ConstUnrolledListIterator tmp = *this;
+			--* this;
+			return tmp;
+		}
+
+		[[nodiscard]] bool operator==(const ConstUnrolledListIterator& other) const noexcept
+		{
+			return ptr == other.ptr && idx == other.idx;
+		}
+
+		[[nodiscard]] bool operator!=(const ConstUnrolledListIterator& other) const noexcept
+		{
+			return !(*this == other);
+		}
+
+		base_ptr ptr;
+		size_t   idx;
+	};
+
+	template<class List>
+	class UnrolledListIterator : public ConstUnrolledListIterator<List>
+	{
+	public:
+		using my_base = ConstUnrolledListIterator<List>;
+
+		using value_type = typename List::value_type;
+		using base_ptr   = typename List::base_ptr;
+		using reference  = value_type&;
+		using pointer    = value_type*;
+
+		UnrolledListIterator() noexcept {}
+
+		explicit UnrolledListIterator(base_ptr ptr, size_t idx = 0) noexcept
+			: my_base(ptr, idx) {}
+
+		[[nodiscard]] reference operator*() const noexcept
+		{
+			return const_cast<reference>(my_base::operator*());
+		}
+
+		[[nodiscard]] pointer operator->() const noexcept
+		{
+			return const_cast<pointer>(my_base::operator->());
+		}
+
+		UnrolledListIterator& operator++() noexcept
+		{
+			my_base::operator++();
+			return *this;
+		}
+
+		UnrolledListIterator operator++(int) noexcept
+		{
+			UnrolledListIterator iterator = *this;
+			my_base::operator++();
+			return iterator;
+		}
+
+		UnrolledListIterator& operator--() noexcept
+		{
+			my_base::operator--();
+			return *this;
+		}
+
+		UnrolledListIterator operator--(int) noexcept
+		{
+			UnrolledListIterator iterator = *this;
+			my_base::operator--();
+			return iterator;
+		}
+	};
+
+	struct UnrolledListNodeBase
+	{
+		UnrolledListNodeBase* next;
+		UnrolledListNodeBase* prev;
+	};
+
+	template<class ValueType, size_t Capacity>
+	struct UnrolledListNode : UnrolledListNodeBase
+	{
+		using value_type = ValueType;
+
+		size_t count = 0;
+		alignas(value_type) unsigned char storage[Capacity * sizeof(value_type)];
+
+		value_type* data() noexcept
+		{
+			return std::launder(reinterpret_cast<value_type*>(storage));
+		}
+
+		const value_type* data() const noexcept
+		{
+			return std::launder(reinterpret_cast<const value_type*>(storage));
+		}
+	};
+
+	template<class ValueType>
+	constexpr size_t unrolled_node_capacity(size_t cache_lines = 2) noexcept
+	{
+		const size_t header = sizeof(UnrolledListNodeBase) + sizeof(size_t);
+		const size_t bytes  = cache_lines * 64;
+
+		return bytes > header && (bytes - header) / sizeof(ValueType) >= 4 ? (bytes - header) / sizeof(ValueType) : 4;
+	}
+
+	template<class ValueType, size_t NodeCapacity = unrolled_node_capacity<ValueType>()>
+	class UnrolledList
+	{
+		static_assert(NodeCapacity >= 2, "UnrolledList node must hold at least two elements");
+
+	public:
+		using value_type = ValueType;
+
+		using reference  = value_type&;
+		using pointer    = value_type*;
+
+		using const_reference = const value_type&;
+		using const_pointer   = const value_type*;
+
+		using node_base = UnrolledListNodeBase;
+		using base_ptr  = node_base*;
+		using node      = UnrolledListNode<value_type, NodeCapacity>;
+		using node_ptr  = node*;
+
+		static constexpr size_t node_capacity = NodeCapacity;
+
+	public:
+		using const_iterator = ConstUnrolledListIterator<UnrolledList>;
+		using iterator       = UnrolledListIterator<UnrolledList>;
+
+	public:
+		UnrolledList() noexcept : size_(0)
+		{
+			head_.next = &head_;
+			head_.prev = &head_;
+		}
+
+		UnrolledList(const UnrolledList& other) : UnrolledList()
+		{
+			for (const_reference value : other)
+				emplace_back(value);
+		}
+
+		UnrolledList(UnrolledList&& other) noexcept : UnrolledList()
+		{
+			swap(other);
+		}
+
+		UnrolledList& operator=(UnrolledList other) noexcept
+		{
+			swap(other);
+			return *this;
+		}
+
+		~UnrolledList()
+		{
+			clear();
+		}
+
+	public:
+		iterator insert(const_iterator where, const value_type& val)
+		{
+			return emplace(where, val);
+		}
+
+		iterator insert(const_iterator where, value_type&& val)
+		{
+			return emplace(where, std::move(val));
+		}
+
+		template<class... Args>
+		iterator emplace(const_iterator where, Args&&... args)
+		{
+			base_ptr ptr = where.ptr;
+			size_t   pos = where.idx;
+
+			if (ptr == &head_ || (pos == 0 && full(ptr) && ptr->prev != &head_ && !full(ptr->prev)))
+			{
+				ptr = ptr->prev;
+				if (ptr == &head_ || full(ptr))
+					ptr = link_node(ptr);
+
+				pos = as_node(ptr)->count;
+			}
+			else if (full(ptr))
+			{
+				split_node(as_node(ptr));
+
+				if (pos > as_node(ptr)->count)
+				{
+					pos -= as_node(ptr)->count;
+					ptr = ptr->next;
+				}
+			}
+
+			insert_in_node(as_node(ptr), pos, std::forward<Args>(args)...);
+			size_ += 1;
+
+			return iterator{ ptr, pos };
+		}
+
+		iterator erase(const_iterator where)
+		{
+			node_ptr n   = as_node(where.ptr);
+			size_t   pos = where.idx;
+
+			erase_in_node(n, pos);
+			size_ -= 1;
+
+			if (n->count == 0)
+			{
+				base_ptr next = n->next;
+				unlink_node(n);
+				return iterator{ next, 0 };
+			}
+
+			if (n->count < NodeCapacity / 2 && n->next != &head_ && n->count + as_node(n->next)->count <= NodeCapacity)
+				merge_next(n);
+
+			if (pos == n->count)
+				return iterator{ n->next, 0 };
+
+			return iterator{ n, pos };
+		}
+
+		void push_back(const value_type& value)
+		{
+			emplace_back(value);
+		}
+
+		void push_back(value_type&& value)
+		{
+			emplace_back(std::move(value));
+		}
+
+		template<class... Args>
+		reference emplace_back(Args&&... args)
+		{
+			return *emplace(cend(), std::forward<Args>(args)...);
+		}
+
+		void push_front(const value_type& value)
+		{
+			emplace_front(value);
+		}
+
+		void push_front(value_type&& value)
+		{
+			emplace_front(std::move(value));
+		}
+
+		template<class... Args>
+		reference emplace_front(Args&&... args)
+		{
+			return *emplace(cbegin(), std::forward<Args>(args)...);
+		}
+
+		void pop_back()
+		{
+			erase(--cend());
+		}
+
+		void pop_front()
+		{
+			erase(cbegin());
+		}
+
+		void clear() noexcept
+		{
+			while (head_.next != &head_)
+			{
+				node_ptr n = as_node(head_.next);
+				std::destroy(n->data(), n->data() + n->count);
+				n->count = 0;
+				unlink_node(n);
+			}
+
+			size_ = 0;
+		}
+
+		void swap(UnrolledList& other) noexcept
+		{
+			std::swap(head_, other.head_);
+			std::swap(size_, other.size_);
+
+			fix_sentinel();
+			other.fix_sentinel();
+		}
+
+		reference front()
+		{
+			return *begin();
+		}
+
+		const_reference front() const
+		{
+			return *begin();
+		}
+
+		reference back()
+		{
+			return *--end();
+		}
+
+		const_reference back() const
+		{
+			return *--end();
+		}
+
+		size_t size() const noexcept
+		{
+			return size_;
+		}
+
+		bool empty() const noexcept
+		{
+			return size_ == 0;
+		}
+
+	private:
+		static node_ptr as_node(base_ptr ptr) noexcept
+		{
+			return static_cast<node_ptr>(ptr);
+		}
+
+		static bool full(base_ptr ptr) noexcept
+		{
+			return as_node(ptr)->count == NodeCapacity;
+		}
+
+		base_ptr link_node(base_ptr after)
+		{
+			node_ptr n = new node;
+			n->prev = after;
+			n->next = after->next;
+			after->next->prev = n;
+			after->next = n;
+
+			return n;
+		}
+
+		void unlink_node(node_ptr n) noexcept
+		{
+			assert(n->count == 0 && "unlinking a non-empty UnrolledList node");
+
+			n->prev->next = n->next;
+			n->next->prev = n->prev;
+			delete n;
+		}
+
+		void fix_sentinel() noexcept
+		{
+			if (size_ == 0)
+			{
+				head_.next = &head_;
+				head_.prev = &head_;
+			}
+			else
+			{
+				head_.next->prev = &head_;
+				head_.prev->next = &head_;
+			}
+		}
+
+		template<class... Args>
+		static void insert_in_node(node_ptr n, size_t pos, Args&&... args)
+		{
+			value_type* data = n->data();
+
+			if (pos == n->count)
+			{
+				::new (static_cast<void*>(data + pos)) value_type(std::forward<Args>(args)...);
+			}
+			else
+			{
+				value_type tmp(std::forward<Args>(args)...);
+				::new (static_cast<void*>(data + n->count)) value_type(std::move(data[n->count - 1]));
+				std::move_backward(data + pos, data + n->count - 1, data + n->count);
+				data[pos] = std::move(tmp);
+			}
+
+			n->count += 1;
+		}
+
+		static void erase_in_node(node_ptr n, size_t pos)
+		{
+			value_type* data = n->data();
+
+			std::move(data + pos + 1, data + n->count, data + pos);
+			std::destroy_at(data + n->count - 1);
+			n->count -= 1;
+		}
+
+		static void relocate(value_type* from, value_type* to, size_t count)
+		{
+			std::uninitialized_move(from, from + count, to);
+			std::destroy(from, from + count);
+		}
+
+		void split_node(node_ptr n)
+		{
+			node_ptr next = as_node(link_node(n));
+			size_t   keep = n->count - n->count / 2;
+
+			relocate(n->data() + keep, next->data(), n->count - keep);
+			next->count = n->count - keep;
+			n->count = keep;
+		}
+
+		void merge_next(node_ptr n)
+		{
+			node_ptr next = as_node(n->next);
+
+			relocate(next->data(), n->data() + n->count, next->count);
+			n->count += next->count;
+			next->count = 0;
+			unlink_node(next);
+		}
+
+	public:
+		[[nodiscard]] iterator begin() noexcept
+		{
+			return iterator{ head_.next };
+		}
+
+		[[nodiscard]] const_iterator cbegin() const noexcept
+		{
+			return const_iterator{ head_.next };
+		}
+
+		[[nodiscard]] iterator end() noexcept
+		{
+			return iterator{ &head_ };
+		}
+
+		[[nodiscard]] const_iterator cend() const noexcept
+		{
+			return const_iterator{ const_cast<base_ptr>(&head_) };
+		}
+
+		[[nodiscard]] const_iterator begin() const noexcept
+		{
+			return cbegin();
+		}
+
+		[[nodiscard]] const_iterator end() const noexcept
+		{
+			return cend();
+		}
+
+	private:
+		node_base head_;
+		size_t    size_;
+	};
+}